@@ -17,6 +17,13 @@
 
 #include "helper.hpp"
 
+#include "viewport.hpp"
+
+#include "../src/frame_timings.hpp"
+#include "../src/renderer.hpp"
+#include "../src/texture.hpp"
+
+#include <utility>
 #include <variant>
 
 API_SECTION("Context");
@@ -61,6 +68,17 @@ GetDeltaTime), in frame per second. Solely for convenience.)")
   return ctx->IO().Framerate;
 }
 
+API_FUNC(0_9, void, RequestRedraw, (ImGui_Context*,ctx)
+(double*,API_RO(delay),0.0),
+R"(Render the frame starting after the given delay in seconds even if there was
+no user input. Only useful with ConfigFlags_EventDriven: call this after
+changing what the script displays without user interaction (eg. new data to
+show) or to run a timer. The earliest pending request is kept.)")
+{
+  assertValid(ctx);
+  ctx->requestRedraw(API_RO_GET(delay));
+}
+
 API_FUNC(0_8, void, Attach, (ImGui_Context*,ctx)(ImGui_Resource*,obj),
 R"(Link the object's lifetime to the given context.
 Objects can be draw list splitters, fonts, images, list clippers, etc.
@@ -88,14 +106,147 @@ ValidatePtr.)")
   ctx->detach(obj);
 }
 
+API_SUBSECTION("Texture Memory",
+R"(Images and font atlases are uploaded to the GPU as textures when used.
+Textures left unused for some time are freed automatically. A memory budget
+may be set to free the least recently used textures sooner.)");
+
+API_FUNC(0_9, void, SetTextureBudget, (ImGui_Context*,ctx)
+(double,bytes),
+R"(Limit the amount of texture memory held by the context. Textures unused in
+the previous frame are evicted, least recently used first, at the beginning of
+the next frame until the total fits within the budget. They are uploaded again
+if used afterward.
+
+Set to 0 to disable the limit (default).)")
+{
+  assertValid(ctx);
+  if(bytes < 0)
+    throw reascript_error { "budget cannot be negative" };
+  ctx->textureManager()->setBudget(bytes);
+}
+
+API_FUNC(0_9, double, GetTextureBudget, (ImGui_Context*,ctx),
+"See SetTextureBudget.")
+{
+  assertValid(ctx);
+  return ctx->textureManager()->budget();
+}
+
+API_FUNC(0_9, void, GetTextureStats, (ImGui_Context*,ctx)
+(int*,API_W(textures))(double*,API_W(bytes))
+(int*,API_W(uploads))(int*,API_W(evictions)),
+R"(Resident texture count and memory usage in bytes, number of textures uploaded
+during the previous frame and number of textures evicted since the creation of
+the context. Textures shared with other contexts are counted by the context
+uploading them.)")
+{
+  assertValid(ctx);
+  const TextureManager::Stats stats { ctx->textureManager()->stats() };
+  if(API_W(textures))  *API_W(textures)  = stats.textures;
+  if(API_W(bytes))     *API_W(bytes)     = stats.bytes;
+  if(API_W(uploads))   *API_W(uploads)   = stats.uploads;
+  if(API_W(evictions)) *API_W(evictions) = stats.evictions;
+}
+
+API_SUBSECTION("Rendering Statistics",
+R"(Consecutive draw commands using the same texture and clipping rectangle are
+merged before being submitted to the GPU. Texture and clipping rectangle
+changes are only made when they differ from the previous draw call.)");
+
+API_FUNC(0_9, void, GetDrawStats, (ImGui_Context*,ctx)
+(int*,API_W(commands))(int*,API_W(draw_calls))
+(int*,API_W(clip_rects))(int*,API_W(textures)),
+R"(Number of draw commands generated during the previous frame, of draw calls
+actually submitted after merging and of clipping rectangle and texture changes.
+Summed across all viewports of the context.)")
+{
+  assertValid(ctx);
+  const DrawBatch::Stats &stats { ctx->rendererFactory()->drawStats() };
+  if(API_W(commands))   *API_W(commands)   = stats.commands;
+  if(API_W(draw_calls)) *API_W(draw_calls) = stats.drawCalls;
+  if(API_W(clip_rects)) *API_W(clip_rects) = stats.clipRects;
+  if(API_W(textures))   *API_W(textures)   = stats.textures;
+}
+
+API_FUNC(0_9, bool, GetFrameTimings, (ImGui_Context*,ctx)
+(ImGui_Viewport*,viewport)(int,stage)
+(double*,API_W(min))(double*,API_W(avg))(double*,API_W(p99)),
+R"(Minimum, average and 99th percentile duration in seconds of a stage of the
+previous frames (up to 120). Returns false if no frames were measured yet.
+
+Stages up to FrameStage_Render are measured for the whole context and ignore
+the viewport. Later stages are measured for each viewport, which must belong to
+the context. FrameStage_GPU is only available with the OpenGL renderer on Linux
+and macOS.)")
+{
+  assertValid(ctx);
+  if(stage < 0 || stage >= ReaImGuiFrameStage_COUNT)
+    throw reascript_error { "invalid frame stage" };
+
+  const TimingHistory *history;
+  if(stage < ReaImGuiFrameStage_Draw)
+    history = &ctx->timings()[stage];
+  else {
+    Context *owner;
+    const ImGuiViewport *instance { viewport->get(&owner) };
+    if(owner != ctx)
+      throw reascript_error { "viewport belongs to another context" };
+    const Renderer *renderer
+      { static_cast<Renderer *>(instance->RendererUserData) };
+    if(!renderer)
+      return false;
+    history = &renderer->timings()[stage];
+  }
+
+  if(!history->count())
+    return false;
+
+  const TimingHistory::Stats &stats { history->stats() };
+  if(API_W(min)) *API_W(min) = stats.min;
+  if(API_W(avg)) *API_W(avg) = stats.avg;
+  if(API_W(p99)) *API_W(p99) = stats.p99;
+  return true;
+}
+
+API_ENUM(0_9, ReaImGui, FrameStage_NewFrame,
+  "Preparation of the frame at the first use of the context in a defer cycle.");
+API_ENUM(0_9, ReaImGui, FrameStage_Script,
+  "Time spent by the script between the start and the end of the frame.");
+API_ENUM(0_9, ReaImGui, FrameStage_Render,
+  "Generation of the draw data of all viewports.");
+API_ENUM(0_9, ReaImGui, FrameStage_Draw,
+  "Submission of the draw data of the viewport to the renderer.");
+API_ENUM(0_9, ReaImGui, FrameStage_Swap,
+  "Presentation of the viewport's frame.");
+API_ENUM(0_9, ReaImGui, FrameStage_GPU,
+  "Execution of the viewport's draw calls by the GPU.");
+
 API_SUBSECTION("Options");
 
+// settings of ReaImGui's context not found in ImGuiIO
+struct ContextVar {
+  double (*get)(const Context *);
+  void (*set)(Context *, double);
+};
+
+template<auto Getter, auto Setter>
+constexpr ContextVar makeContextVar()
+{
+  using T = decltype((std::declval<const Context &>().*Getter)());
+  return {
+    [](const Context *ctx) -> double { return (ctx->*Getter)(); },
+    [](Context *ctx, const double value)
+      { (ctx->*Setter)(static_cast<T>(value)); },
+  };
+}
+
 template<typename... T>
-using IOFields = std::variant<T ImGuiIO::*...>;
+using ConfigVars = std::variant<T ImGuiIO::*..., ContextVar>;
 
 // expose most settings from ImGuiIO
 // ITEM ORDER MUST MATCH WITH THE API_CONFIGVAR() BELOW!
-static constexpr IOFields<bool, float, int> g_configVars[] {
+static constexpr ConfigVars<bool, float, int> g_configVars[] {
   &ImGuiIO::ConfigFlags,
 
   &ImGuiIO::MouseDoubleClickTime,
@@ -129,6 +280,9 @@ static constexpr IOFields<bool, float, int> g_configVars[] {
 
   &ImGuiIO::ConfigDebugBeginReturnValueOnce,
   &ImGuiIO::ConfigDebugBeginReturnValueLoop,
+
+  makeContextVar<&Context::maxFramerate, &Context::setMaxFramerate>(),
+  makeContextVar<&Context::swapInterval, &Context::setSwapInterval>(),
 };
 
 #define API_CONFIGVAR(vernum, name, doc) \
@@ -203,6 +357,16 @@ Will cycle through window depths then repeat. Suggested use: add
 in your main loop then occasionally press SHIFT.
 Windows should be flickering while running.)");
 
+API_CONFIGVAR(0_9, MaxFramerate,
+R"(Maximum number of frames rendered per second, 0 for no limit (default).
+   Frames over the limit still run the script but are not rendered: the
+   windows keep showing the previous frame. The defer timer rate (~30 Hz) is
+   the upper limit.)");
+API_CONFIGVAR(0_9, SwapInterval,
+R"(Number of vertical blanks to wait for before presenting a frame: 0 for
+   immediately, 1 for vsync. -1 to use the renderer's default (default).
+   Metal only supports on (>= 1) or off. Not supported by the Linux renderer.)");
+
 static_assert(__COUNTER__ - baseConfigVar - 1 == std::size(g_configVars),
   "forgot to API_CONFIGVAR() a config var?");
 
@@ -214,16 +378,20 @@ API_FUNC(0_7, double, GetConfigVar, (ImGui_Context*,ctx)
   if(static_cast<size_t>(var_idx) >= std::size(g_configVars))
     throw reascript_error { "unknown config variable" };
 
-  return std::visit([ctx](auto ImGuiIO::*field) -> double {
-    const ImGuiIO &io { ctx->IO() };
+  return std::visit([ctx](auto field) -> double {
+    if constexpr(std::is_same_v<ContextVar, decltype(field)>)
+      return field.get(ctx);
+    else {
+      const ImGuiIO &io { ctx->IO() };
 
-    if constexpr(std::is_same_v<decltype(ImGuiIO::ConfigFlags),
-                                std::decay_t<decltype(io.*field)>>) {
-      if(field == &ImGuiIO::ConfigFlags)
-        return ctx->userConfigFlags();
-    }
+      if constexpr(std::is_same_v<decltype(ImGuiIO::ConfigFlags),
+                                  std::decay_t<decltype(io.*field)>>) {
+        if(field == &ImGuiIO::ConfigFlags)
+          return ctx->userConfigFlags();
+      }
 
-    return io.*field;
+      return io.*field;
+    }
   }, g_configVars[var_idx]);
 }
 
@@ -235,18 +403,22 @@ API_FUNC(0_7, void, SetConfigVar, (ImGui_Context*,ctx)
   if(static_cast<size_t>(var_idx) >= std::size(g_configVars))
     throw reascript_error { "unknown config variable" };
 
-  std::visit([ctx, value](auto ImGuiIO::*field) {
-    ImGuiIO &io { ctx->IO() };
-
-    if constexpr(std::is_same_v<decltype(ImGuiIO::ConfigFlags),
-                                std::decay_t<decltype(io.*field)>>) {
-      if(field == &ImGuiIO::ConfigFlags) {
-        ctx->setUserConfigFlags(value);
-        return;
+  std::visit([ctx, value](auto field) {
+    if constexpr(std::is_same_v<ContextVar, decltype(field)>)
+      field.set(ctx, value);
+    else {
+      ImGuiIO &io { ctx->IO() };
+
+      if constexpr(std::is_same_v<decltype(ImGuiIO::ConfigFlags),
+                                  std::decay_t<decltype(io.*field)>>) {
+        if(field == &ImGuiIO::ConfigFlags) {
+          ctx->setUserConfigFlags(value);
+          return;
+        }
       }
-    }
 
-    io.*field = value;
+      io.*field = value;
+    }
   }, g_configVars[var_idx]);
 }
 
@@ -271,3 +443,27 @@ API_ENUM(0_5, ImGui, ConfigFlags_DockingEnable,
 
 API_ENUM(0_4, ReaImGui, ConfigFlags_NoSavedSettings,
   "Disable state restoration and persistence for the whole context.");
+API_ENUM(0_9, ReaImGui, ConfigFlags_ImageAtlas,
+R"(Pack small images (up to 64x64 pixels) into shared textures so that
+consecutive images can be drawn in a single draw call. Images drawn using
+texture coordinates outside of the 0.0-1.0 range (tiling) keep using their own
+texture.)");
+API_ENUM(0_9, ReaImGui, ConfigFlags_Headless,
+R"(Render windows offscreen on the CPU instead of into native windows.
+Mouse input is disabled. Set when creating the context.
+See Viewport_Capture and Viewport_CaptureToPNG.)");
+API_ENUM(0_9, ReaImGui, ConfigFlags_RenderThread,
+R"(Draw and present the windows on a background thread from a copy of their
+draw data, letting the script run while the previous frame is being drawn.
+Set when creating the context.
+
+Applies to headless contexts (capture functions wait for the frame to be
+complete) and to the OpenGL and Direct3D renderers on Windows. Textures are
+still uploaded from the main thread. Native windows on macOS and Linux are
+always drawn on the main thread.)");
+API_ENUM(0_9, ReaImGui, ConfigFlags_EventDriven,
+R"(Power-saving mode: frames without user input, texture changes or window
+resizes are not rendered and the viewports keep showing the last rendered
+frame. The script still runs every defer cycle. Rendering continues for a
+second after the last input for hover delays and animations to complete.
+Use RequestRedraw when the content changes for other reasons.)");
@@ -346,11 +346,13 @@ API_FUNC(0_8, void, DrawList_AddImage, (ImGui_DrawList*,draw_list)
   Context *ctx;
   ImDrawList *dl { draw_list->get(&ctx) };
   assertValid(img);
-  dl->AddImage(img->makeTexture(ctx->textureManager()),
-    ImVec2(p_min_x, p_min_y), ImVec2(p_max_x, p_max_y),
+  ImVec2 uv[] {
     ImVec2(API_RO_GET(uv_min_x), API_RO_GET(uv_min_y)),
     ImVec2(API_RO_GET(uv_max_x), API_RO_GET(uv_max_y)),
-    Color::fromBigEndian(API_RO_GET(col_rgba)));
+  };
+  const ImTextureID tex { img->makeTexture(ctx, uv, std::size(uv)) };
+  dl->AddImage(tex, ImVec2(p_min_x, p_min_y), ImVec2(p_max_x, p_max_y),
+    uv[0], uv[1], Color::fromBigEndian(API_RO_GET(col_rgba)));
 }
 
 API_FUNC(0_8, void, DrawList_AddImageQuad, (ImGui_DrawList*,draw_list)
@@ -366,14 +368,17 @@ API_FUNC(0_8, void, DrawList_AddImageQuad, (ImGui_DrawList*,draw_list)
   Context *ctx;
   ImDrawList *dl { draw_list->get(&ctx) };
   assertValid(img);
-  dl->AddImageQuad(img->makeTexture(ctx->textureManager()),
-    ImVec2(p1_x, p1_y), ImVec2(p2_x, p2_y),
-    ImVec2(p3_x, p3_y), ImVec2(p4_x, p4_y),
+  ImVec2 uv[] {
     ImVec2(API_RO_GET(uv1_x), API_RO_GET(uv1_y)),
     ImVec2(API_RO_GET(uv2_x), API_RO_GET(uv2_y)),
     ImVec2(API_RO_GET(uv3_x), API_RO_GET(uv3_y)),
     ImVec2(API_RO_GET(uv4_x), API_RO_GET(uv4_y)),
-    Color::fromBigEndian(API_RO_GET(col_rgba)));
+  };
+  const ImTextureID tex { img->makeTexture(ctx, uv, std::size(uv)) };
+  dl->AddImageQuad(tex,
+    ImVec2(p1_x, p1_y), ImVec2(p2_x, p2_y),
+    ImVec2(p3_x, p3_y), ImVec2(p4_x, p4_y),
+    uv[0], uv[1], uv[2], uv[3], Color::fromBigEndian(API_RO_GET(col_rgba)));
 }
 
 API_FUNC(0_8, void, DrawList_AddImageRounded, (ImGui_DrawList*,draw_list)
@@ -385,10 +390,10 @@ API_FUNC(0_8, void, DrawList_AddImageRounded, (ImGui_DrawList*,draw_list)
   Context *ctx;
   ImDrawList *dl { draw_list->get(&ctx) };
   assertValid(img);
-  dl->AddImageRounded(img->makeTexture(ctx->textureManager()),
-    ImVec2(p_min_x, p_min_y), ImVec2(p_max_x, p_max_y),
-    ImVec2(uv_min_x, uv_min_y), ImVec2(uv_max_x, uv_max_y),
-    Color::fromBigEndian(col_rgba), rounding, API_RO_GET(flags));
+  ImVec2 uv[] { ImVec2(uv_min_x, uv_min_y), ImVec2(uv_max_x, uv_max_y) };
+  const ImTextureID tex { img->makeTexture(ctx, uv, std::size(uv)) };
+  dl->AddImageRounded(tex, ImVec2(p_min_x, p_min_y), ImVec2(p_max_x, p_max_y),
+    uv[0], uv[1], Color::fromBigEndian(col_rgba), rounding, API_RO_GET(flags));
 }
 
 API_SUBSECTION("Stateful Path",
@@ -19,6 +19,9 @@
 
 #include "../src/color.hpp"
 #include "../src/image.hpp"
+#include "../src/image_cache.hpp"
+
+#include <reaper_plugin_secrets.h> // reaper_array
 
 API_SECTION("Image",
 R"(ReaImGui currently supports loading PNG and JPEG bitmap images.
@@ -33,25 +36,97 @@ There are also image functions in the DrawList API such as
 DrawList_AddImageQuad and DrawList_AddImageRounded.)");
 
 API_FUNC(0_9, ImGui_Image*, CreateImage,
-(const char*,file)(int*,API_RO(flags)),
+(const char*,file)(int*,API_RO(flags),ReaImGuiImageFlags_None)
+(int*,API_RO(max_w),0)(int*,API_RO(max_h),0),
 R"(The returned object is valid as long as it is used in each defer cycle
 unless attached to a context (see Attach).
 
-('flags' currently unused and reserved for future expansion))")
+Images larger than max_w or max_h are decoded at a smaller size preserving
+their aspect ratio (0 = no limit). JPEG images are scaled while decoding
+which is faster and uses less memory than loading them at full size.
+
+See ImageFlags_Cache to reuse the decoded pixels of a file across calls.)")
 {
-  (void)API_RO(flags);
-  return Image::fromFile(file);
+  return Image::fromFile(file, { API_RO_GET(max_w), API_RO_GET(max_h) },
+    API_RO_GET(flags));
 }
 
 API_FUNC(0_9, ImGui_Image*, CreateImageFromMem,
-(const char*,data)(int,data_sz),
+(const char*,data)(int,data_sz)(int*,API_RO(max_w),0)(int*,API_RO(max_h),0),
 R"(Requires REAPER v6.44 or newer for EEL and Lua. Load from a file using
-CreateImage or explicitely specify data_sz if supporting older versions.)")
+CreateImage or explicitely specify data_sz if supporting older versions.
+
+See CreateImage for the meaning of max_w and max_h.)")
 {
   // data_sz is inaccurate before REAPER 6.44
-  return Image::fromMemory(data, data_sz);
+  return Image::fromMemory(data, data_sz,
+    { API_RO_GET(max_w), API_RO_GET(max_h) });
+}
+
+API_FUNC(0_9, ImGui_Image*, CreateImageAsync,
+(const char*,file)(int*,API_RO(flags),ReaImGuiImageFlags_None)
+(int*,API_RO(max_w),0)(int*,API_RO(max_h),0),
+R"(Same as CreateImage, except the file is decoded in the background instead
+of blocking until it is loaded. The image has a size of 0x0 and is drawn as
+fully transparent until ready. Poll Image_IsReady or Image_GetState to know
+when it can be used.)")
+{
+  return new AsyncImage { file, { API_RO_GET(max_w), API_RO_GET(max_h) },
+    API_RO_GET(flags) };
+}
+
+API_FUNC(0_9, bool, Image_IsReady, (ImGui_Image*,img),
+R"(Whether the image has finished loading. Always true for images not created
+using CreateImageAsync.)")
+{
+  assertValid(img);
+  return img->state() == ReaImGuiImageState_Ready;
+}
+
+API_FUNC(0_9, int, Image_GetState, (ImGui_Image*,img)
+(char*,API_W(error))(int,API_W_SZ(error)),
+R"(Returns one of ImageState_*. 'error' is set to the reason of the failure
+when the state is ImageState_Failed.
+
+An image set is loading if any of its images is loading, and failed if any
+of its images could not be loaded.)")
+{
+  assertValid(img);
+  const ImageState state { img->state() };
+  if(API_W(error)) {
+    const std::string_view error { img->error() };
+    snprintf(API_W(error), API_W_SZ(error), "%.*s",
+      static_cast<int>(error.size()), error.data());
+  }
+  return state;
 }
 
+API_ENUM(0_9, ReaImGui, ImageFlags_None, "");
+API_ENUM(0_9, ReaImGui, ImageFlags_Cache,
+R"(Keep the decoded pixels in memory after the image is destroyed for reuse
+by later calls loading the same unmodified file with the same maximum size,
+including from other scripts. Up to 128 MiB of the least recently loaded
+images are kept. See GetImageCacheStats.)");
+
+API_FUNC(0_9, void, GetImageCacheStats,
+(int*,API_W(hits))(int*,API_W(misses))(int*,API_W(images))(double*,API_W(bytes)),
+R"(Number of images loaded from the cache or decoded (cache misses) since
+REAPER was started, and count and memory usage in bytes of the cached images.
+Only images created using ImageFlags_Cache are counted.)")
+{
+  const ImageCache::Stats stats { ImageCache::get().stats() };
+  if(API_W(hits))   *API_W(hits)   = stats.hits;
+  if(API_W(misses)) *API_W(misses) = stats.misses;
+  if(API_W(images)) *API_W(images) = stats.images;
+  if(API_W(bytes))  *API_W(bytes)  = stats.bytes;
+}
+
+API_ENUM(0_9, ReaImGui, ImageState_Ready, "");
+API_ENUM(0_9, ReaImGui, ImageState_Loading,
+  "The image is being decoded in the background.");
+API_ENUM(0_9, ReaImGui, ImageState_Failed,
+  "The image could not be loaded, see Image_GetState.");
+
 API_FUNC(0_8, void, Image_GetSize, (ImGui_Image*,img)
 (double*,API_W(w))(double*,API_W(h)),
 "")
@@ -71,10 +146,12 @@ API_FUNC(0_8, void, Image, (ImGui_Context*,ctx)
   FRAME_GUARD;
   assertValid(img);
 
-  const ImTextureID tex { img->makeTexture(ctx->textureManager()) };
-  ImGui::Image(tex, ImVec2(size_w, size_h),
+  ImVec2 uv[] {
     ImVec2(API_RO_GET(uv0_x), API_RO_GET(uv0_y)),
     ImVec2(API_RO_GET(uv1_x), API_RO_GET(uv1_y)),
+  };
+  const ImTextureID tex { img->makeTexture(ctx, uv, std::size(uv)) };
+  ImGui::Image(tex, ImVec2(size_w, size_h), uv[0], uv[1],
     Color(API_RO_GET(tint_col_rgba)), Color(API_RO_GET(border_col_rgba)));
 }
 
@@ -88,13 +165,93 @@ API_FUNC(0_8, bool, ImageButton, (ImGui_Context*,ctx)
   FRAME_GUARD;
   assertValid(img);
 
-  const ImTextureID tex { img->makeTexture(ctx->textureManager()) };
-  return ImGui::ImageButton(str_id, tex, ImVec2(size_w, size_h),
+  ImVec2 uv[] {
     ImVec2(API_RO_GET(uv0_x), API_RO_GET(uv0_y)),
     ImVec2(API_RO_GET(uv1_x), API_RO_GET(uv1_y)),
+  };
+  const ImTextureID tex { img->makeTexture(ctx, uv, std::size(uv)) };
+  return ImGui::ImageButton(str_id, tex, ImVec2(size_w, size_h), uv[0], uv[1],
     Color(API_RO_GET(bg_col_rgba)), Color(API_RO_GET(tint_col_rgba)));
 }
 
+API_SUBSECTION("Pixels",
+R"(Images whose straight (non-premultiplied) RGBA pixels are computed by the
+script and updated in place, for example to draw meters or spectrograms.
+Only the updated region is uploaded again to the GPU.
+
+Pixels are given either as a binary string of 4 bytes per pixel (red, green,
+blue and alpha) or as a reaper_array of one 0xRRGGBBAA color per pixel.
+Rows are ordered from top to bottom and tightly packed to the width of
+the image or region.)");
+
+static PixelImage *toPixelImage(ImGui_Image *img)
+{
+  assertValid(img);
+  if(PixelImage *pixels { dynamic_cast<PixelImage *>(img) })
+    return pixels;
+  throw reascript_error { "image was not created from pixels" };
+}
+
+static void assertPixelCount(const int width, const int height,
+  const size_t size, const size_t sizePerPixel)
+{
+  if(width < 1 || height < 1)
+    return; // reported by PixelImage
+
+  const size_t expected { static_cast<size_t>(width) * height * sizePerPixel };
+  if(size != expected) {
+    throw reascript_error { "expected {} values for {}x{} pixels, got {}",
+      expected, width, height, size };
+  }
+}
+
+API_FUNC(0_9, ImGui_Image*, CreateImageFromPixels,
+(int,width)(int,height)(const char*,pixels)(int,pixels_sz),
+R"(Pixels may be empty to create a fully transparent image.
+Requires REAPER v6.44 or newer for EEL and Lua (see CreateImageFromMem).)")
+{
+  if(pixels_sz > 0)
+    assertPixelCount(width, height, pixels_sz, 4);
+
+  PixelImage *img { new PixelImage { width, height } };
+  if(pixels_sz > 0) {
+    img->update(0, 0, width, height,
+      reinterpret_cast<const unsigned char *>(pixels));
+  }
+  return img;
+}
+
+API_FUNC(0_9, ImGui_Image*, CreateImageFromPixels_Array,
+(int,width)(int,height)(reaper_array*,pixels),
+"")
+{
+  assertValid(pixels);
+  assertPixelCount(width, height, pixels->size, 1);
+  PixelImage *img { new PixelImage { width, height } };
+  img->update(0, 0, width, height, pixels->data);
+  return img;
+}
+
+API_FUNC(0_9, void, Image_UpdatePixels, (ImGui_Image*,img)
+(int,x)(int,y)(int,w)(int,h)(const char*,pixels)(int,pixels_sz),
+R"(Replace the pixels of a region of an image created using
+CreateImageFromPixels.)")
+{
+  PixelImage *image { toPixelImage(img) };
+  assertPixelCount(w, h, pixels_sz, 4);
+  image->update(x, y, w, h, reinterpret_cast<const unsigned char *>(pixels));
+}
+
+API_FUNC(0_9, void, Image_UpdatePixels_Array, (ImGui_Image*,img)
+(int,x)(int,y)(int,w)(int,h)(reaper_array*,pixels),
+"See Image_UpdatePixels.")
+{
+  PixelImage *image { toPixelImage(img) };
+  assertValid(pixels);
+  assertPixelCount(w, h, pixels->size, 1);
+  image->update(x, y, w, h, pixels->data);
+}
+
 API_SUBSECTION("Image Set",
 R"(Helper to automatically select and scale an image to the DPI scale of
 the current window upon usage.
@@ -19,6 +19,8 @@
 
 #include "viewport.hpp"
 
+#include "../src/offscreen_viewport.hpp"
+
 API_SECTION("Viewport");
 
 API_FUNC(0_1, ImGui_Viewport*, GetMainViewport, (ImGui_Context*,ctx),
@@ -89,3 +91,35 @@ API_FUNC(0_1, void, Viewport_GetWorkCenter, (ImGui_Viewport*,viewport)
   if(API_W(x)) *API_W(x) = pos.x;
   if(API_W(y)) *API_W(y) = pos.y;
 }
+
+API_SUBSECTION("Capture",
+R"(Pixels of the last frame rendered in a viewport of a context created with
+ConfigFlags_Headless, available after the end of the defer cycle.)");
+
+static OffscreenViewport *getOffscreen(ImGui_Viewport *viewport)
+{
+  OffscreenViewport *offscreen { OffscreenViewport::get(viewport->get()) };
+  if(!offscreen)
+    throw reascript_error { "viewport is not rendered offscreen" };
+  return offscreen;
+}
+
+API_FUNC(0_9, void, Viewport_Capture, (ImGui_Viewport*,viewport)
+(char*,API_WBIG(rgba))(int,API_WBIG_SZ(rgba))
+(int*,API_W(w))(int*,API_W(h)),
+R"(Copy the pixels of the last rendered frame as 8-bit RGBA (4 bytes per pixel,
+top row first). Width and height are in pixels.)")
+{
+  const OffscreenViewport *offscreen { getOffscreen(viewport) };
+  if(API_WBIG(rgba))
+    copyToBigBuf(API_WBIG(rgba), API_WBIG_SZ(rgba), offscreen->capture());
+  if(API_W(w)) *API_W(w) = offscreen->width();
+  if(API_W(h)) *API_W(h) = offscreen->height();
+}
+
+API_FUNC(0_9, void, Viewport_CaptureToPNG, (ImGui_Viewport*,viewport)
+(const char*,file),
+"Write the pixels of the last rendered frame into a PNG file.")
+{
+  getOffscreen(viewport)->writePNG(file);
+}
@@ -15,8 +15,8 @@
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
-#ifndef REAIMGUI_VIEWPORT_HPP
-#define REAIMGUI_VIEWPORT_HPP
+#ifndef REAIMGUI_API_VIEWPORT_HPP
+#define REAIMGUI_API_VIEWPORT_HPP
 
 #include "../src/resource_proxy.hpp"
 
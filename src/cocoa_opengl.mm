@@ -40,6 +40,7 @@ public:
 private:
   GLPool *contextPool() const;
   NSOpenGLContext *m_gl;
+  GLint m_swapInterval;
 };
 
 class MakeCurrent {
@@ -63,7 +64,7 @@ decltype(OpenGLRenderer::creator) OpenGLRenderer::creator
   { &Renderer::create<CocoaOpenGL> };
 
 CocoaOpenGL::CocoaOpenGL(RendererFactory *factory, Window *window)
-  : OpenGLRenderer { factory, window }
+  : OpenGLRenderer { factory, window }, m_swapInterval { 0 }
 {
   NSView *view { (__bridge NSView *)window->nativeHandle() };
   [view setWantsBestResolutionOpenGLSurface:YES]; // retina
@@ -76,8 +77,8 @@ CocoaOpenGL::CocoaOpenGL(RendererFactory *factory, Window *window)
     0
   };
 
-  if(!m_shared->m_platform)
-    m_shared->m_platform = std::make_shared<GLPool>();
+  if(!m_shared->m_group->m_platform)
+    m_shared->m_group->m_platform = std::make_shared<GLPool>();
 
   auto pool { contextPool() };
   NSOpenGLPixelFormat *fmt { [[NSOpenGLPixelFormat alloc] initWithAttributes:attrs] };
@@ -104,20 +105,29 @@ CocoaOpenGL::~CocoaOpenGL()
 
 GLPool *CocoaOpenGL::contextPool() const
 {
-  return std::static_pointer_cast<GLPool>(m_shared->m_platform).get();
+  return std::static_pointer_cast<GLPool>(m_shared->m_group->m_platform).get();
 }
 
 void CocoaOpenGL::setSize(ImVec2)
 {
   [m_gl update];
+  invalidate();
 }
 
 void CocoaOpenGL::render(void *)
 {
   // the intial setView in show() may fail if the view doesn't have a "device"
   // (eg. when docked not activated = hidden NSView)
-  if(![m_gl view])
+  if(![m_gl view]) {
     [m_gl setView:(__bridge NSView *)m_window->nativeHandle()];
+    invalidate(); // keep rendering until the view is displayed
+  }
+
+  if(const GLint interval { swapInterval() };
+      interval >= 0 && interval != m_swapInterval) {
+    [m_gl setValues:&interval forParameter:NSOpenGLContextParameterSwapInterval];
+    m_swapInterval = interval;
+  }
 
   MakeCurrent cur { m_gl };
   OpenGLRenderer::updateTextures();
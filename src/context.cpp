@@ -21,6 +21,7 @@
 #include "docker.hpp"
 #include "error.hpp"
 #include "font.hpp"
+#include "image_atlas.hpp"
 #include "keymap.hpp"
 #include "platform.hpp"
 #include "renderer.hpp"
@@ -28,7 +29,9 @@
 #include "texture.hpp"
 #include "viewport.hpp"
 #include "window.hpp"
+#include "worker_pool.hpp"
 
+#include <algorithm>
 #include <cassert>
 #include <imgui/imgui_internal.h>
 #include <reaper_plugin_functions.h>
@@ -43,10 +46,18 @@ enum RightClickEmulation { Armed, Active };
 constexpr ImGuiMouseButton DND_MouseButton { ImGuiMouseButton_Left };
 constexpr ImGuiConfigFlags PRIVATE_CONFIG_FLAGS
   { ImGuiConfigFlags_ViewportsEnable };
+// including the main thread
+constexpr unsigned int MAX_RENDER_THREADS { 8 };
+// keep rendering after input in event-driven mode for the layout to settle
+// and for hover delays and short animations to complete
+constexpr std::chrono::seconds ACTIVITY_REDRAW_TIME { 1 };
 
 static ImFontAtlas * const NO_DEFAULT_ATLAS
   { reinterpret_cast<ImFontAtlas *>(-1) };
 
+static unsigned int g_contextCount;
+static std::unique_ptr<WorkerPool> g_workers; // stopped with the last context
+
 class TempCurrent {
 public:
   TempCurrent(Context *ctx)
@@ -86,20 +97,25 @@ Context *Context::current()
 }
 
 Context::Context(const char *label, const int userConfigFlags)
-  : m_dndWasActive { false }, m_cursor {},
+  : m_dndWasActive { false }, m_renderPending { false }, m_skipRender { false },
+    m_cursor {}, m_maxFramerate { 0.0 }, m_swapInterval { -1 },
     m_lastFrame       { decltype(m_lastFrame)::clock::now()                },
+    m_redrawAt        { m_lastFrame                                        },
+    m_textureVersion  { 0                                                  },
     m_name            { label, ImGui::FindRenderedTextEnd(label)           },
     m_iniFilename     { generateIniFilename(label)                         },
     m_imgui           { ImGui::CreateContext(NO_DEFAULT_ATLAS)             },
     m_dockers         { std::make_unique<DockerList>()                     },
     m_textureManager  { std::make_unique<TextureManager>()                 },
     m_fonts           { std::make_unique<FontList>(m_textureManager.get()) },
-    m_rendererFactory { std::make_unique<RendererFactory>()                }
+    m_rendererFactory { std::make_unique<RendererFactory>()                },
+    m_windowPool      { std::make_unique<WindowPool>()                     }
 {
   static const std::string logFn
     { std::string { GetResourcePath() } + WDL_DIRCHAR_STR "imgui_log.txt" };
 
   setCurrent();
+  ++g_contextCount;
 
   ImGuiIO &io { m_imgui->IO };
   io.BackendRendererName = m_rendererFactory->name();
@@ -138,6 +154,10 @@ Context::~Context()
 
   // destroy windows while this and m_imgui are still valid
   ImGui::DestroyPlatformWindows();
+  m_windowPool.reset();
+
+  if(--g_contextCount == 0)
+    g_workers.reset();
 }
 
 void Context::ContextDeleter::operator()(ImGuiContext *imgui)
@@ -195,7 +215,7 @@ void Context::detach(Resource *obj)
 
 bool Context::heartbeat()
 {
-  if(m_imgui->WithinFrameScope) {
+  if(m_imgui->WithinFrameScope || m_renderPending) {
     if(!endFrame(true))
       return false;
 
@@ -213,6 +233,21 @@ ImGuiIO &Context::IO()
   return m_imgui->IO;
 }
 
+ImageAtlas *Context::imageAtlas()
+{
+  if(!(m_imgui->IO.ConfigFlags & ReaImGuiConfigFlags_ImageAtlas))
+    return nullptr;
+  else if(!m_imageAtlas)
+    m_imageAtlas = std::make_unique<ImageAtlas>(m_textureManager.get());
+
+  return m_imageAtlas.get();
+}
+
+bool Context::isHeadless() const
+{
+  return m_imgui->IO.ConfigFlags & ReaImGuiConfigFlags_Headless;
+}
+
 ImGuiStyle &Context::style()
 {
   return m_imgui->Style;
@@ -227,21 +262,29 @@ bool Context::beginFrame() try
 {
   assert(!m_imgui->WithinFrameScope);
 
+  StageTimer timer { m_timings[ReaImGuiFrameStage_NewFrame] };
   Platform::updateMonitors(); // TODO only if changed
   m_fonts->update(); // uses the monitor list
 
   // remove unused textures before texture IDs are given out for this frame
+  if(m_imageAtlas)
+    m_imageAtlas->cleanup();
   m_textureManager->cleanup();
+  m_rendererFactory->nextFrame();
 
+  const ImVec2 prevDisplaySize { m_imgui->IO.DisplaySize };
   updateFrameInfo();
-  updateMouseData();
+  if(!isHeadless()) // offscreen viewports receive no input
+    updateMouseData();
   updateSettings();
+  m_skipRender = skipRender(prevDisplaySize);
 
   ImGui::NewFrame();
 
   dragSources();
   m_dockers->drawAll();
 
+  m_scriptStart = decltype(m_scriptStart)::clock::now();
   return true;
 }
 catch(const backend_error &e) {
@@ -268,11 +311,20 @@ bool Context::endFrame(const bool render) try
     return true;
   }
 
-  updateCursor();
-  updateDragDrop();
-  ImGui::Render();
-  ImGui::UpdatePlatformWindows();
-  ImGui::RenderPlatformWindowsDefault();
+  if(m_skipRender) // the viewports keep showing the previous frame
+    ImGui::EndFrame();
+  else {
+    if(!m_renderPending) {
+      finishFrame();
+      renderDrawData();
+    }
+    m_renderPending = false;
+    if(m_renderError)
+      std::rethrow_exception(std::exchange(m_renderError, nullptr));
+
+    ImGui::UpdatePlatformWindows();
+    ImGui::RenderPlatformWindowsDefault(); // timed by each renderer
+  }
 
 #ifdef FOCUS_POLLING
   // WM_KILLFOCUS/WM_ACTIVATE+WA_INACTIVE are incomplete or missing in SWELL
@@ -292,6 +344,66 @@ catch(const backend_error &e) {
   return false;
 }
 
+// work done on the main thread before ImGui::Render as it may use the
+// native windowing APIs (cursor, drag and drop, IME)
+void Context::finishFrame()
+{
+  const std::chrono::duration<double> scriptTime
+    { decltype(m_scriptStart)::clock::now() - m_scriptStart };
+  m_timings[ReaImGuiFrameStage_Script].add(scriptTime.count());
+
+  updateCursor();
+  updateDragDrop();
+  ImGui::EndFrame();
+}
+
+// may run on any thread, errors are rethrown by endFrame
+void Context::renderDrawData() noexcept
+{
+  setCurrent();
+
+  try {
+    StageTimer timer { m_timings[ReaImGuiFrameStage_Render] };
+    ImGui::Render();
+  }
+  catch(...) {
+    m_renderError = std::current_exception();
+  }
+}
+
+void Context::renderFrames()
+{
+  std::vector<Context *> contexts;
+  Resource::foreach<Context>([&contexts](Context *ctx) {
+    if(ctx->m_imgui->WithinFrameScope && !ctx->m_skipRender)
+      contexts.push_back(ctx);
+  });
+
+  if(contexts.size() < 2)
+    return; // not worth the synchronization, done by endFrame
+
+  std::vector<WorkerPool::Job> jobs;
+  for(Context *ctx : contexts) {
+    ctx->m_renderPending = true;
+    try {
+      ctx->setCurrent();
+      ctx->finishFrame();
+    }
+    catch(...) {
+      ctx->m_renderError = std::current_exception();
+      continue;
+    }
+    jobs.push_back(std::bind(&Context::renderDrawData, ctx));
+  }
+
+  if(!g_workers) {
+    const unsigned int threads { std::thread::hardware_concurrency() };
+    g_workers = std::make_unique<WorkerPool>
+      (std::clamp(threads, 1u, MAX_RENDER_THREADS) - 1);
+  }
+  g_workers->run(jobs);
+}
+
 void Context::updateFrameInfo()
 {
   ImGuiIO &io { m_imgui->IO };
@@ -308,9 +420,88 @@ void Context::updateFrameInfo()
   m_lastFrame = now;
 }
 
+bool Context::hasActivity(const ImVec2 &prevDisplaySize)
+{
+  const ImGuiIO &io { m_imgui->IO };
+  const TextureVersion textureVersion { m_textureManager->version() };
+  bool active {
+    m_imgui->InputEventsQueue.Size > 0 ||
+    io.DisplaySize.x != prevDisplaySize.x ||
+    io.DisplaySize.y != prevDisplaySize.y ||
+    textureVersion != m_textureVersion ||
+    // interactions spanning multiple frames (dragging, text cursor blinking)
+    m_imgui->ActiveId || m_imgui->DragDropActive || io.WantTextInput
+  };
+  m_textureVersion = textureVersion;
+
+  const ImGuiPlatformIO &pio { m_imgui->PlatformIO };
+  for(int i {}; !active && i < pio.Viewports.Size; ++i) {
+    const ImGuiViewport *viewport { pio.Viewports[i] };
+    active = viewport->PlatformRequestMove || viewport->PlatformRequestResize ||
+             viewport->PlatformRequestClose;
+  }
+
+  return active;
+}
+
+// whether the viewports can keep showing the previous frame instead
+bool Context::skipRender(const ImVec2 &prevDisplaySize)
+{
+  using namespace std::chrono;
+  using Clock = decltype(m_lastFrame)::clock;
+
+  const ImGuiIO &io { m_imgui->IO };
+  const auto now { m_lastFrame };
+
+  const bool eventDriven { (io.ConfigFlags & ReaImGuiConfigFlags_EventDriven) != 0 };
+  if(eventDriven && hasActivity(prevDisplaySize))
+    m_activeUntil = now + ACTIVITY_REDRAW_TIME;
+
+  // early by up to half a timer period for the limit to be reachable
+  const auto slack
+    { duration_cast<Clock::duration>(duration<float> { io.DeltaTime / 2 }) };
+  if(m_maxFramerate > 0.0 && now + slack < m_nextRender)
+    return true; // activity and redraw requests are handled later
+
+  if(eventDriven) {
+    if(now >= m_redrawAt)
+      m_redrawAt = decltype(m_redrawAt)::max();
+    else if(now >= m_activeUntil)
+      return true;
+  }
+
+  if(m_maxFramerate > 0.0) {
+    const auto interval { duration_cast<Clock::duration>
+      (duration<double> { 1.0 / m_maxFramerate }) };
+    // keep a steady cadence unless far behind
+    m_nextRender = (now - m_nextRender > interval ? now : m_nextRender) + interval;
+  }
+
+  return false;
+}
+
+void Context::setMaxFramerate(const double fps)
+{
+  m_maxFramerate = std::max(0.0, fps);
+}
+
+void Context::setSwapInterval(const int interval)
+{
+  m_swapInterval = std::max(-1, interval);
+}
+
+void Context::requestRedraw(const double delay)
+{
+  using Clock = decltype(m_redrawAt)::clock;
+  const auto at { Clock::now() + std::chrono::duration_cast<Clock::duration>
+    (std::chrono::duration<double> { std::max(0.0, delay) }) };
+  m_redrawAt = std::min(m_redrawAt, at);
+}
+
 void Context::updateCursor()
 {
-  if(m_imgui->IO.ConfigFlags & ImGuiConfigFlags_NoMouseCursorChange)
+  if(isHeadless() ||
+      (m_imgui->IO.ConfigFlags & ImGuiConfigFlags_NoMouseCursorChange))
     return;
 
   // ImGui::GetMouseCursor is only valid after a frame, before Render
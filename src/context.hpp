@@ -18,10 +18,12 @@
 #ifndef REAIMGUI_CONTEXT_HPP
 #define REAIMGUI_CONTEXT_HPP
 
+#include "frame_timings.hpp"
 #include "resource.hpp"
 
 #include <bitset>
 #include <chrono>
+#include <exception>
 #include <memory>
 #include <string>
 #include <vector>
@@ -36,13 +38,19 @@
 
 class DockerList;
 class FontList;
+class ImageAtlas;
 class RendererFactory;
 class TextureManager;
+class WindowPool;
 struct ImGuiContext;
 struct ImGuiViewport;
 
 enum ConfigFlags {
   ReaImGuiConfigFlags_NoSavedSettings = 1<<20,
+  ReaImGuiConfigFlags_ImageAtlas      = 1<<21,
+  ReaImGuiConfigFlags_Headless        = 1<<22,
+  ReaImGuiConfigFlags_RenderThread    = 1<<23,
+  ReaImGuiConfigFlags_EventDriven     = 1<<24,
 };
 
 constexpr const char *REAIMGUI_PAYLOAD_TYPE_FILES { "_FILES" };
@@ -50,6 +58,9 @@ constexpr const char *REAIMGUI_PAYLOAD_TYPE_FILES { "_FILES" };
 class Context final : public Resource {
 public:
   static Context *current();
+  // finalizes the draw data of every context within a frame concurrently
+  // (their viewports are updated and drawn later by heartbeat)
+  static void renderFrames();
 
   Context(const char *label, int userConfigFlags = ImGuiConfigFlags_None);
   ~Context();
@@ -76,6 +87,13 @@ public:
   void updateFocus();
   void enableViewports(bool enable);
   void invalidateViewportsPos();
+  void requestRedraw(double delay = 0.0); // in seconds
+
+  // pacing
+  double maxFramerate() const { return m_maxFramerate; }
+  void setMaxFramerate(double fps);
+  int swapInterval() const { return m_swapInterval; }
+  void setSwapInterval(int);
 
   ImGuiIO &IO();
   ImGuiStyle &style();
@@ -84,9 +102,13 @@ public:
   HCURSOR cursor() const { return m_cursor; }
   ImGuiContext *imgui() const { return m_imgui.get(); }
   TextureManager *textureManager() const { return m_textureManager.get(); }
+  ImageAtlas *imageAtlas(); // nullptr unless enabled
+  bool isHeadless() const;
   RendererFactory *rendererFactory() const { return m_rendererFactory.get(); }
+  WindowPool &windowPool() { return *m_windowPool; }
   const char *name() const { return m_name.c_str(); }
   const auto &draggedFiles() const { return m_draggedFiles; }
+  const FrameTimings &timings() const { return m_timings; }
 
   bool attachable(const Context *) const override { return false; }
 
@@ -96,6 +118,8 @@ protected:
 private:
   bool beginFrame();
   bool endFrame(bool render);
+  void finishFrame();
+  void renderDrawData() noexcept;
   void assertOutOfFrame();
 
   void updateFrameInfo();
@@ -103,18 +127,30 @@ private:
   void updateMouseData();
   void updateSettings();
   void updateDragDrop();
+  bool hasActivity(const ImVec2 &prevDisplaySize);
+  bool skipRender(const ImVec2 &prevDisplaySize);
 
   ImGuiViewport *viewportUnder(ImVec2) const;
   ImGuiViewport *focusedViewport() const;
   void dragSources();
   void clearFocus();
 
-  bool m_dndWasActive;
+  bool m_dndWasActive, m_renderPending, m_skipRender;
   HCURSOR m_cursor;
+  double m_maxFramerate; // 0 = unlimited
+  int m_swapInterval;    // -1 = renderer's default
 #ifdef __APPLE__
   std::bitset<2> m_rightClickEmulation;
 #endif
   std::chrono::time_point<std::chrono::steady_clock> m_lastFrame; // monotonic
+  std::chrono::time_point<std::chrono::steady_clock> m_scriptStart;
+  // event-driven mode
+  std::chrono::time_point<std::chrono::steady_clock> m_redrawAt, m_activeUntil;
+  unsigned int m_textureVersion;
+  // frame rate limit
+  std::chrono::time_point<std::chrono::steady_clock> m_nextRender;
+  FrameTimings m_timings;
+  std::exception_ptr m_renderError;
   std::vector<std::string> m_draggedFiles;
   std::vector<Resource *> m_attachments;
   std::string m_name, m_iniFilename;
@@ -123,8 +159,10 @@ private:
   std::unique_ptr<ImGuiContext, ContextDeleter> m_imgui;
   std::unique_ptr<DockerList> m_dockers;
   std::unique_ptr<TextureManager> m_textureManager;
+  std::unique_ptr<ImageAtlas> m_imageAtlas;
   std::unique_ptr<FontList> m_fonts;
   std::unique_ptr<RendererFactory> m_rendererFactory;
+  std::unique_ptr<WindowPool> m_windowPool;
 };
 
 using ImGui_Context = Context; // user-facing alias
@@ -20,9 +20,11 @@
 #include "context.hpp"
 #include "error.hpp"
 #include "import.hpp"
+#include "render_thread.hpp"
 #include "texture.hpp"
 #include "window.hpp"
 
+#include <algorithm>
 #include <atlbase.h>
 #include <d3d10.h>
 #include <imgui/imgui.h>
@@ -56,6 +58,8 @@ private:
     ~Shared();
 
     void textureCommand(const TextureCmd &);
+    void updateRegion(ID3D10ShaderResourceView *,
+      const Texture &, const TextureCmd::Region &);
 
     CComPtr<ID3D10Device> m_device;
     CComPtr<IDXGIFactory> m_factory;
@@ -83,11 +87,19 @@ private:
   void createRenderTarget();
   bool setupBuffer(Buffer &, unsigned int wantSize,
     unsigned int reserveExtra, unsigned int stride, unsigned int bindFlags);
+  void updateTextures();
+  // only uses the given frame and the device, may run on the render thread
+  void draw(const ImDrawData *, const DrawBatch &, float scale, bool clear);
+  // waits until no window of the context is using the device
+  void syncRenderThread() const;
 
   std::shared_ptr<Shared> m_shared;
   CComPtr<IDXGISwapChain> m_swapChain;
   CComPtr<ID3D10RenderTargetView> m_renderTarget;
   std::array<Buffer, 3> m_buffers;
+  std::shared_ptr<RenderThread> m_renderThread;
+  RenderThread::Ticket m_frame;
+  DrawDataSnapshot m_snapshot;
 };
 
 D3D10Renderer::Shared::Shared()
@@ -215,6 +227,11 @@ void D3D10Renderer::Shared::textureCommand(const TextureCmd &cmd)
     // calls Release() on the textures in the range to replace
     std::fill_n(m_textures.begin() + cmd.offset, cmd.size, nullptr);
     break;
+  case TextureCmd::UpdateRegion:
+    for(size_t i {}; i < cmd.size; ++i)
+      updateRegion(m_textures[cmd.offset + i], cmd[i], cmd.region);
+    cmd.manager->addUploads(cmd.size);
+    return;
   case TextureCmd::Remove:
     m_textures.erase(m_textures.begin() + cmd.offset,
                      m_textures.begin() + cmd.offset + cmd.size);
@@ -251,16 +268,46 @@ void D3D10Renderer::Shared::textureCommand(const TextureCmd &cmd)
     m_device->CreateShaderResourceView(texture,
       &resourceViewDesc, &m_textures[cmd.offset + i]);
   }
+
+  cmd.manager->addUploads(cmd.size);
+}
+
+void D3D10Renderer::Shared::updateRegion(ID3D10ShaderResourceView *view,
+  const Texture &texture, const TextureCmd::Region &region)
+{
+  int width, height;
+  const unsigned char *pixels { texture.getPixels(&width, &height) };
+  pixels += ((region.top * width) + region.left) * 4;
+
+  CComPtr<ID3D10Resource> resource;
+  view->GetResource(&resource);
+
+  const D3D10_BOX box {
+    .left   = static_cast<unsigned int>(region.left),
+    .top    = static_cast<unsigned int>(region.top),
+    .front  = 0,
+    .right  = static_cast<unsigned int>(region.right),
+    .bottom = static_cast<unsigned int>(region.bottom),
+    .back   = 1,
+  };
+  m_device->UpdateSubresource(resource, 0, &box, pixels, width * 4, 0);
 }
 
 D3D10Renderer::D3D10Renderer(RendererFactory *factory, Window *window)
-  : Renderer { window }
+  : Renderer { window }, m_frame { 0 }
 {
+  // set for every window of the context: the device is never used by
+  // the main thread and the render thread at the same time
+  if(window->context()->IO().ConfigFlags & ReaImGuiConfigFlags_RenderThread)
+    m_renderThread = RenderThread::get();
+
   m_shared = factory->getSharedData<Shared>();
   if(!m_shared) {
     m_shared = std::make_shared<Shared>();
     factory->setSharedData(m_shared);
   }
+  else
+    syncRenderThread();
 
   DXGI_SWAP_CHAIN_DESC swapChainDesc {
     .BufferDesc = {
@@ -291,6 +338,13 @@ D3D10Renderer::D3D10Renderer(RendererFactory *factory, Window *window)
 
 D3D10Renderer::~D3D10Renderer()
 {
+  syncRenderThread(); // including the last frame of this window
+}
+
+void D3D10Renderer::syncRenderThread() const
+{
+  if(m_renderThread)
+    m_renderThread->waitAll();
 }
 
 void D3D10Renderer::createRenderTarget()
@@ -327,6 +381,7 @@ bool D3D10Renderer::setupBuffer(Buffer &buffer, const unsigned int wantSize,
 
 void D3D10Renderer::setSize(const ImVec2 size)
 {
+  syncRenderThread();
   m_shared->m_device->OMSetRenderTargets(0, nullptr, nullptr);
   m_renderTarget = nullptr; // before resizing the swap chain buffer
 
@@ -338,28 +393,63 @@ void D3D10Renderer::setSize(const ImVec2 size)
   createRenderTarget();
 }
 
-void D3D10Renderer::render(void *)
+void D3D10Renderer::updateTextures()
 {
   using namespace std::placeholders;
   m_window->context()->textureManager()->update(&m_shared->m_cookie,
     std::bind(&Shared::textureCommand, m_shared.get(), _1));
+}
 
+void D3D10Renderer::render(void *)
+{
   const ImGuiViewport *viewport { m_window->viewport() };
-  const ImDrawData *drawData { viewport->DrawData };
+  const float scale { viewport->DpiScale };
+  const bool clear { !(viewport->Flags & ImGuiViewportFlags_NoRendererClear) };
 
+  if(!m_renderThread) {
+    updateTextures();
+    draw(viewport->DrawData,
+      batchDrawCalls(viewport->DrawData, ImVec2(scale, scale)), scale, clear);
+    return;
+  }
+
+  // the snapshot and the draw batch are in use until the previous frame
+  // of this window is presented
+  m_renderThread->wait(m_frame);
+
+  // uploads read pixels owned by the main thread
+  const TextureManager *manager { m_window->context()->textureManager() };
+  if(!manager->isSynced(m_shared->m_cookie)) {
+    syncRenderThread();
+    updateTextures();
+  }
+
+  m_snapshot.copy(viewport->DrawData);
+
+  const int interval { std::clamp(swapInterval(), 0, 4) };
+  const DrawBatch *batch
+    { &batchDrawCalls(m_snapshot.get(), ImVec2(scale, scale)) };
+
+  m_frame = m_renderThread->push([this, batch, scale, clear, interval] {
+    draw(m_snapshot.get(), *batch, scale, clear);
+    m_swapChain->Present(interval, 0);
+  });
+}
+
+void D3D10Renderer::draw(const ImDrawData *drawData, const DrawBatch &batch,
+  const float scale, const bool clear)
+{
   ID3D10Device *device { m_shared->m_device };
   device->OMSetRenderTargets(1, &m_renderTarget.p, nullptr);
 
-  if(!(viewport->Flags & ImGuiViewportFlags_NoRendererClear)) {
+  if(clear) {
     constexpr float clearColor[] { 0.f, 0.f, 0.f, 0.f };
     device->ClearRenderTargetView(m_renderTarget, clearColor);
   }
 
   const D3D10_VIEWPORT viewportDesc {
-    .Width  =
-      static_cast<unsigned int>(drawData->DisplaySize.x * viewport->DpiScale),
-    .Height =
-      static_cast<unsigned int>(drawData->DisplaySize.y * viewport->DpiScale),
+    .Width  = static_cast<unsigned int>(drawData->DisplaySize.x * scale),
+    .Height = static_cast<unsigned int>(drawData->DisplaySize.y * scale),
     .MinDepth = 0.0f, .MaxDepth = 1.0f,
   };
   m_shared->m_device->RSSetViewports(1, &viewportDesc);
@@ -407,34 +497,26 @@ void D3D10Renderer::render(void *)
   device->IASetIndexBuffer(m_buffers[IndexBuf],
     sizeof(ImDrawIdx) == 2 ? DXGI_FORMAT_R16_UINT : DXGI_FORMAT_R32_UINT, 0);
 
-  const ImVec2 &clipOffset { drawData->DisplayPos },
-               &clipScale  { viewport->DpiScale, viewport->DpiScale };
-  int globalVtxOffset {}, globalIdxOffset {};
-  for(int i {}; i < drawData->CmdListsCount; ++i) {
-    const ImDrawList *cmdList { drawData->CmdLists[i] };
-    for(int j {}; j < cmdList->CmdBuffer.Size; ++j) {
-      const ImDrawCmd *cmd { &cmdList->CmdBuffer[j] };
-      if(cmd->UserCallback)
-        continue; // no need to call the callback, not using them
-
-      const ClipRect clipRect { cmd->ClipRect, clipOffset, clipScale };
-      static_assert(sizeof(ClipRect) == sizeof(D3D10_RECT));
-      if(!clipRect)
-        continue;
-      device->RSSetScissorRects(1, reinterpret_cast<const D3D10_RECT *>(&clipRect));
-
-      ID3D10ShaderResourceView *texture { m_shared->m_textures[cmd->GetTexID()] };
+  static_assert(sizeof(ClipRect) == sizeof(D3D10_RECT));
+  for(const DrawBatch::Call &call : batch) {
+    if(call.setClipRect) {
+      device->RSSetScissorRects(1,
+        reinterpret_cast<const D3D10_RECT *>(&call.clipRect));
+    }
+    if(call.setTexture) {
+      ID3D10ShaderResourceView *texture { m_shared->m_textures[call.texture] };
       device->PSSetShaderResources(0, 1, &texture);
-      device->DrawIndexed(cmd->ElemCount, cmd->IdxOffset + globalIdxOffset,
-                                          cmd->VtxOffset + globalVtxOffset);
     }
-
-    globalVtxOffset += cmdList->VtxBuffer.Size;
-    globalIdxOffset += cmdList->IdxBuffer.Size;
+    device->DrawIndexed(call.elemCount, call.idxOffset, call.vtxOffset);
   }
 }
 
 void D3D10Renderer::swapBuffers(void *)
 {
-  m_swapChain->Present(0, 0); // present immediately (no vsync)
+  if(m_renderThread) // presented by the render thread along with the frame
+    return;
+
+  // present immediately (no vsync) by default
+  const int interval { std::clamp(swapInterval(), 0, 4) };
+  m_swapChain->Present(interval, 0);
 }
@@ -0,0 +1,40 @@
+/* ReaImGui: ReaScript binding for Dear ImGui
+ * Copyright (C) 2021-2024  Christian Fillion
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "decoder_pool.hpp"
+
+#include <algorithm>
+#include <memory>
+
+static std::unique_ptr<DecoderPool> g_instance;
+
+DecoderPool &DecoderPool::get()
+{
+  if(!g_instance) {
+    // leave a core to REAPER's main and audio threads
+    const unsigned int cores { std::thread::hardware_concurrency() };
+    const unsigned int threads { std::clamp(cores / 2, 1u, MAX_THREADS) };
+    g_instance = std::make_unique<DecoderPool>(threads);
+  }
+  return *g_instance;
+}
+
+void DecoderPool::teardown()
+{
+  g_instance.reset();
+}
@@ -0,0 +1,38 @@
+/* ReaImGui: ReaScript binding for Dear ImGui
+ * Copyright (C) 2021-2024  Christian Fillion
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef REAIMGUI_DECODER_POOL_HPP
+#define REAIMGUI_DECODER_POOL_HPP
+
+#include "job_queue.hpp"
+
+// Executes image decoding jobs on background threads, starting them in
+// submission order (several may complete in any order)
+class DecoderPool : public JobQueue {
+public:
+  static constexpr unsigned int MAX_THREADS { 4 };
+
+  // started on first use and kept until teardown()
+  static DecoderPool &get();
+  static void teardown();
+
+  // jobs that have not started are discarded when destroyed
+  DecoderPool(unsigned int threads) : JobQueue { threads, Pending::Discard } {}
+};
+
+#endif
@@ -0,0 +1,58 @@
+/* ReaImGui: ReaScript binding for Dear ImGui
+ * Copyright (C) 2021-2024  Christian Fillion
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "frame_timings.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+TimingHistory::TimingHistory()
+  : m_samples {}, m_next { 0 }, m_count { 0 }
+{
+}
+
+void TimingHistory::add(const double seconds)
+{
+  m_samples[m_next] = seconds;
+  m_next = (m_next + 1) % m_samples.size();
+  m_count = std::min(m_count + 1, m_samples.size());
+}
+
+TimingHistory::Stats TimingHistory::stats() const
+{
+  if(!m_count)
+    return {};
+
+  std::array<float, SIZE> sorted;
+  const auto begin { sorted.begin() }, end { begin + m_count };
+  std::copy_n(m_samples.begin(), m_count, begin);
+
+  double sum {};
+  for(auto it { begin }; it < end; ++it)
+    sum += *it;
+
+  // nearest-rank percentile
+  const size_t rank
+    { static_cast<size_t>(std::ceil(0.99 * m_count)) - 1 };
+  std::nth_element(begin, begin + rank, end);
+
+  return {
+    .min = *std::min_element(begin, end),
+    .avg = sum / m_count,
+    .p99 = begin[rank],
+  };
+}
@@ -0,0 +1,76 @@
+/* ReaImGui: ReaScript binding for Dear ImGui
+ * Copyright (C) 2021-2024  Christian Fillion
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef REAIMGUI_FRAME_TIMINGS_HPP
+#define REAIMGUI_FRAME_TIMINGS_HPP
+
+#include <array>
+#include <chrono>
+
+enum FrameStage {
+  // per context
+  ReaImGuiFrameStage_NewFrame, // Context::beginFrame
+  ReaImGuiFrameStage_Script,   // between the beginning and the end of the frame
+  ReaImGuiFrameStage_Render,   // ImGui::Render, possibly on a worker thread
+  // per viewport
+  ReaImGuiFrameStage_Draw,     // Renderer::render (CPU)
+  ReaImGuiFrameStage_Swap,     // Renderer::swapBuffers (CPU)
+  ReaImGuiFrameStage_GPU,      // execution of the draw commands, when measurable
+
+  ReaImGuiFrameStage_COUNT,
+};
+
+// Rolling statistics over the durations of the last frames (in seconds)
+class TimingHistory {
+public:
+  static constexpr size_t SIZE { 120 };
+
+  struct Stats {
+    double min, avg, p99;
+  };
+
+  TimingHistory();
+
+  void add(double seconds);
+  size_t count() const { return m_count; }
+  Stats stats() const;
+
+private:
+  std::array<float, SIZE> m_samples;
+  size_t m_next, m_count;
+};
+
+using FrameTimings = std::array<TimingHistory, ReaImGuiFrameStage_COUNT>;
+
+// Adds the time elapsed until destruction using a monotonic clock
+class StageTimer {
+public:
+  StageTimer(TimingHistory &history)
+    : m_history { history }, m_start { std::chrono::steady_clock::now() } {}
+  ~StageTimer()
+  {
+    const std::chrono::duration<double> elapsed
+      { std::chrono::steady_clock::now() - m_start };
+    m_history.add(elapsed.count());
+  }
+
+private:
+  TimingHistory &m_history;
+  std::chrono::steady_clock::time_point m_start;
+};
+
+#endif
@@ -17,10 +17,14 @@
 
 #include "opengl_renderer.hpp"
 
+#include "context.hpp"
 #include "error.hpp"
 #include "gdk_window.hpp"
 
+#include <algorithm>
+#include <array>
 #include <cassert>
+#include <cstring>
 #include <epoxy/gl.h>
 #include <gtk/gtk.h>
 #include <imgui/imgui.h>
@@ -37,10 +41,22 @@ public:
   void setSize(ImVec2) override;
   void render(void *) override;
   void swapBuffers(void *) override;
+  bool paint() override;
 
 private:
+  struct Readback {
+    unsigned int buffer;
+    GLsync fence;
+    std::vector<ClipRect> regions;
+  };
+
   void initSoftwareBlit();
+  void initReadback();
   void resizeTextures(ImVec2);
+  void updateDamage();
+  void readPixels();
+  void copyReadback();
+  void discardReadback();
   void softwareBlit();
 
   GdkGLContext *m_gl;
@@ -49,6 +65,17 @@ private:
   // for docking
   std::unique_ptr<LICE_IBitmap, LICEDeleter> m_pixels;
   std::shared_ptr<GdkWindow> m_offscreen;
+  // frames are read back through pixel buffers without waiting for the GPU
+  // and copied into m_pixels when the window is painted
+  std::array<Readback, 2> m_readbacks;
+  Readback *m_pendingReadback;
+  size_t m_nextReadback;
+  bool m_asyncReadback;
+  // only the areas that changed since the previous frame are read back
+  DamageTracker m_damage;
+  std::vector<ClipRect> m_readRegions;
+  TextureVersion m_textureVersion;
+  unsigned int m_uploadGeneration;
 };
 
 class MakeCurrent {
@@ -74,7 +101,10 @@ decltype(OpenGLRenderer::creator) OpenGLRenderer::creator
 // GdkGLContext cannot share ressources: they're already shared with the
 // window's paint context (which itself isn't shared with anything).
 GDKOpenGL::GDKOpenGL(RendererFactory *factory, Window *window)
-  : OpenGLRenderer(factory, window, false)
+  : OpenGLRenderer(factory, window, false), m_readbacks {},
+    m_pendingReadback { nullptr }, m_nextReadback { 0 },
+    m_asyncReadback { false }, m_textureVersion { 0 },
+    m_uploadGeneration { 0 }
 {
   GdkWindow *osWindow;
 
@@ -108,6 +138,9 @@ GDKOpenGL::GDKOpenGL(RendererFactory *factory, Window *window)
 
   MakeCurrent cur { m_gl };
 
+  if(m_pixels)
+    initReadback();
+
   glGenTextures(1, &m_tex);
   resizeTextures(m_window->viewport()->Size); // binds to the texture and sets its size
 
@@ -131,6 +164,12 @@ GDKOpenGL::~GDKOpenGL()
     glDeleteFramebuffers(1, &m_fbo);
     glDeleteTextures(1, &m_tex);
 
+    if(m_asyncReadback) {
+      discardReadback();
+      for(const Readback &readback : m_readbacks)
+        glDeleteBuffers(1, &readback.buffer);
+    }
+
     teardown();
   }
 
@@ -156,10 +195,25 @@ void GDKOpenGL::initSoftwareBlit()
     m_offscreen = g_offscreen.lock();
 }
 
+void GDKOpenGL::initReadback()
+{
+  // pixel buffer objects are core since 2.1 and fences since 3.2
+  m_asyncReadback = epoxy_gl_version() >= 32 ||
+    (epoxy_has_gl_extension("GL_ARB_pixel_buffer_object") &&
+     epoxy_has_gl_extension("GL_ARB_sync"));
+  if(!m_asyncReadback)
+    return;
+
+  for(Readback &readback : m_readbacks)
+    glGenBuffers(1, &readback.buffer);
+}
+
 void GDKOpenGL::setSize(const ImVec2 size)
 {
   MakeCurrent cur { m_gl };
   resizeTextures(size);
+  invalidate(); // the previous frame was discarded
+  m_damage.invalidate();
 }
 
 void GDKOpenGL::resizeTextures(ImVec2 size)
@@ -176,29 +230,40 @@ void GDKOpenGL::resizeTextures(ImVec2 size)
     LICE_FillRect(m_pixels.get(), 0, 0, size.x, size.y, 0, 1.f, 0);
     glPixelStorei(GL_PACK_ROW_LENGTH, LICE__GetRowSpan(m_pixels.get()));
   }
+
+  if(m_asyncReadback) {
+    discardReadback(); // of the previous size
+    const size_t bufferSize { static_cast<size_t>(
+      LICE__GetRowSpan(m_pixels.get())) * LICE__GetHeight(m_pixels.get()) * 4 };
+    for(const Readback &readback : m_readbacks) {
+      glBindBuffer(GL_PIXEL_PACK_BUFFER, readback.buffer);
+      glBufferData(GL_PIXEL_PACK_BUFFER, bufferSize, nullptr, GL_STREAM_READ);
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+  }
 }
 
-void GDKOpenGL::render(void *userData)
+void GDKOpenGL::render(void *)
 {
-  if(userData && m_pixels)
-    return softwareBlit();
-
   MakeCurrent cur { m_gl };
 
   // FIXME: Currently we use SWELL's DPI scale which is fixed & app-wide.
   // If this changes, we'll want to only upload textures for our own DPI
   // since we're not sharing them with other windows.
   const bool useSoftwareBlit { m_window->isDocked() };
+  if(useSoftwareBlit)
+    updateDamage(); // before updateTextures completes streamed uploads
   OpenGLRenderer::updateTextures();
   OpenGLRenderer::render(useSoftwareBlit);
 
   if(useSoftwareBlit) {
     // REAPER is also drawing to the same GdkWindow so we must share it.
     // Switch to slower render path, copying pixels into a LICE bitmap.
-    glReadPixels(0, 0,
-      LICE__GetWidth(m_pixels.get()), LICE__GetHeight(m_pixels.get()),
-      GL_BGRA, GL_UNSIGNED_BYTE, LICE__GetBits(m_pixels.get()));
-    InvalidateRect(m_window->nativeHandle(), nullptr, false); // post a WM_PAINT
+    readPixels();
+    for(const ClipRect &region : m_readRegions) {
+      const RECT rect { region.left, region.top, region.right, region.bottom };
+      InvalidateRect(m_window->nativeHandle(), &rect, false); // post a WM_PAINT
+    }
     return;
   }
 
@@ -218,21 +283,163 @@ void GDKOpenGL::render(void *userData)
   gdk_window_freeze_updates(window);
 }
 
+void GDKOpenGL::updateDamage()
+{
+  // textures may change without affecting the draw data
+  const TextureVersion textureVersion
+    { m_window->context()->textureManager()->version() };
+  const unsigned int uploadGeneration { this->uploadGeneration() };
+  if(textureVersion != m_textureVersion ||
+      uploadGeneration != m_uploadGeneration || isDirty()) {
+    m_textureVersion   = textureVersion;
+    m_uploadGeneration = uploadGeneration;
+    m_damage.invalidate();
+  }
+
+  const ImGuiViewport *viewport { m_window->viewport() };
+  m_damage.update(viewport->DrawData,
+    ImVec2(viewport->DpiScale, viewport->DpiScale));
+}
+
+void GDKOpenGL::readPixels()
+{
+  LICE_IBitmap *bitmap { m_pixels.get() };
+  const long width { LICE__GetWidth(bitmap) }, height { LICE__GetHeight(bitmap) };
+
+  m_readRegions.clear();
+  const auto addRegions { [&](const std::vector<ClipRect> &regions) {
+    for(ClipRect region : regions) {
+      region.right  = std::min(region.right,  width);
+      region.bottom = std::min(region.bottom, height);
+      if(region)
+        m_readRegions.push_back(region);
+    }
+  }};
+  addRegions(m_damage.regions());
+  if(m_pendingReadback) // superseded before being painted
+    addRegions(m_pendingReadback->regions);
+
+  if(m_readRegions.empty())
+    return;
+
+  const auto readRegions { [this](void *pixels) {
+    // the offsets in the destination match the bitmap's layout
+    for(const ClipRect &region : m_readRegions) {
+      glPixelStorei(GL_PACK_SKIP_PIXELS, region.left);
+      glPixelStorei(GL_PACK_SKIP_ROWS,   region.top);
+      glReadPixels(region.left, region.top, region.right - region.left,
+        region.bottom - region.top, GL_BGRA, GL_UNSIGNED_BYTE, pixels);
+    }
+    glPixelStorei(GL_PACK_SKIP_PIXELS, 0);
+    glPixelStorei(GL_PACK_SKIP_ROWS,   0);
+  }};
+
+  if(!m_asyncReadback) {
+    readRegions(LICE__GetBits(bitmap));
+    return;
+  }
+
+  discardReadback();
+
+  // alternate buffers to not overwrite one the driver may still be copying
+  Readback &readback { m_readbacks[m_nextReadback] };
+  m_nextReadback = (m_nextReadback + 1) % m_readbacks.size();
+
+  glBindBuffer(GL_PIXEL_PACK_BUFFER, readback.buffer);
+  readRegions(nullptr);
+  glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+  readback.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+  readback.regions = m_readRegions;
+  glFlush(); // start the transfer now instead of when painting
+
+  m_pendingReadback = &readback;
+}
+
+void GDKOpenGL::copyReadback()
+{
+  // normally completed long before WM_PAINT is received
+  constexpr GLuint64 TIMEOUT_NS { 1'000'000'000 };
+  const GLenum status { glClientWaitSync(m_pendingReadback->fence,
+    GL_SYNC_FLUSH_COMMANDS_BIT, TIMEOUT_NS) };
+  if(status == GL_TIMEOUT_EXPIRED || status == GL_WAIT_FAILED) {
+    // read back the whole frame again as the dropped regions are now stale
+    discardReadback();
+    m_damage.invalidate();
+    invalidate();
+    m_window->context()->requestRedraw();
+    return;
+  }
+
+  LICE_IBitmap *bitmap { m_pixels.get() };
+  const int rowSpan { LICE__GetRowSpan(bitmap) };
+  const size_t size
+    { static_cast<size_t>(rowSpan) * LICE__GetHeight(bitmap) * sizeof(LICE_pixel) };
+
+  glBindBuffer(GL_PIXEL_PACK_BUFFER, m_pendingReadback->buffer);
+  if(const auto *pixels { static_cast<const LICE_pixel *>(
+      glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, size, GL_MAP_READ_BIT)) }) {
+    LICE_pixel *bits { LICE__GetBits(bitmap) };
+    for(const ClipRect &region : m_pendingReadback->regions) {
+      const size_t rowSize ((region.right - region.left) * sizeof(LICE_pixel));
+      for(long y { region.top }; y < region.bottom; ++y) {
+        const size_t offset ((y * rowSpan) + region.left);
+        std::memcpy(bits + offset, pixels + offset, rowSize);
+      }
+    }
+    glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+  }
+  glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+  discardReadback();
+}
+
+void GDKOpenGL::discardReadback()
+{
+  if(!m_pendingReadback)
+    return;
+
+  glDeleteSync(m_pendingReadback->fence);
+  m_pendingReadback->fence = nullptr;
+  m_pendingReadback = nullptr;
+}
+
 void GDKOpenGL::swapBuffers(void *)
 {
 }
 
+bool GDKOpenGL::paint()
+{
+  if(!m_pixels)
+    return false;
+
+  if(m_pendingReadback) {
+    MakeCurrent cur { m_gl };
+    copyReadback();
+  }
+
+  softwareBlit();
+  return true;
+}
+
 void GDKOpenGL::softwareBlit()
 {
   PAINTSTRUCT ps;
   if(!BeginPaint(m_window->nativeHandle(), &ps))
     return;
 
-  const int width  { LICE__GetWidth(m_pixels.get())  },
-            height { LICE__GetHeight(m_pixels.get()) };
-
-  StretchBltFromMem(ps.hdc, 0, 0, width, height, LICE__GetBits(m_pixels.get()),
-    width, height, LICE__GetRowSpan(m_pixels.get()));
+  // only the invalidated area
+  const RECT &rect { ps.rcPaint };
+  const int left   { std::max<int>(rect.left, 0) },
+            top    { std::max<int>(rect.top,  0) },
+            right  { std::min<int>(rect.right,  LICE__GetWidth(m_pixels.get()))  },
+            bottom { std::min<int>(rect.bottom, LICE__GetHeight(m_pixels.get())) };
+  const int rowSpan { LICE__GetRowSpan(m_pixels.get()) };
+
+  if(right > left && bottom > top) {
+    StretchBltFromMem(ps.hdc, left, top, right - left, bottom - top,
+      LICE__GetBits(m_pixels.get()) + (top * rowSpan) + left,
+      right - left, bottom - top, rowSpan);
+  }
 
   EndPaint(m_window->nativeHandle(), &ps);
 }
@@ -108,11 +108,24 @@ void GDKWindow::initIME()
 
 void GDKWindow::show()
 {
+  if(m_renderer) { // reused from a WindowPool, see hide()
+    gdk_window_show(getOSWindow());
+    return;
+  }
+
   Window::show();
   initIME();
   m_renderer = m_ctx->rendererFactory()->create(this);
 }
 
+void GDKWindow::hide()
+{
+  // Bypassing SWELL as it destroys the OS window when hidden, taking the
+  // renderer's GL context (and its textures) with it
+  if(GdkWindow *native { getOSWindow() })
+    gdk_window_hide(native);
+}
+
 ImVec2 GDKWindow::getPosition() const
 {
   GdkWindow *native { getOSWindow() };
@@ -321,10 +334,6 @@ std::optional<LRESULT> GDKWindow::handleMessage
   case WM_SYSKEYUP:
     keyEvent(wParam, lParam, msg == WM_KEYDOWN || msg == WM_SYSKEYDOWN);
     return 0;
-  case WM_PAINT:
-    if(m_renderer) // do software blit
-      m_renderer->render(reinterpret_cast<void *>(1));
-    break;
   case WM_MOVE:
     if(m_eatNextMove) {
       m_eatNextMove = false;
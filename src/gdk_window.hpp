@@ -49,6 +49,9 @@ public:
 
   GdkWindow *getOSWindow() const;
 
+protected:
+  void hide() override;
+
 private:
   static void imePreeditStart(GtkIMContext *, void *);
   static void imePreeditEnd(GtkIMContext *, void *);
@@ -17,14 +17,29 @@
 
 #include "image.hpp"
 
+#include "context.hpp"
+#include "decoder_pool.hpp"
 #include "error.hpp"
+#include "image_atlas.hpp"
+#include "image_cache.hpp"
+#include "mapped_file.hpp"
 #include "texture.hpp"
 #include "win32_unicode.hpp"
 
+#include <atomic>
 #include <boost/iostreams/stream.hpp>
-#include <cmath> // abs
+#include <cmath> // abs, lround
+#include <cstdint>
+#include <cstring> // memcpy
 #include <fstream>
 #include <imgui/imgui.h>
+#include <unordered_set>
+
+struct AsyncImage::Job {
+  std::atomic<ImageState> state;
+  std::shared_ptr<const BitmapData> data;
+  std::string error;
+};
 
 static const Image::RegisterType *&typeHead()
 {
@@ -32,17 +47,19 @@ static const Image::RegisterType *&typeHead()
   return head;
 }
 
-Image::RegisterType::RegisterType(const TestFunc test, const CreateFunc create)
-  : m_test { test }, m_create { create }, m_next { typeHead() }
+Image::RegisterType::RegisterType(const TestFunc test, const DecodeFunc decode,
+    const DecodeMemoryFunc decodeMemory)
+  : m_test { test }, m_decode { decode }, m_decodeMemory { decodeMemory },
+    m_next { typeHead() }
 {
   typeHead() = this;
 }
 
-static Image *create(std::istream &stream)
+static const Image::RegisterType &findType(std::istream &stream)
 {
   for(const Image::RegisterType *type { typeHead() }; type; type = type->m_next) {
     if(type->m_test(stream))
-      return type->m_create(stream);
+      return *type;
     else
       stream.seekg(0);
   }
@@ -50,38 +67,81 @@ static Image *create(std::istream &stream)
   throw reascript_error { "unsupported format" };
 }
 
-Image *Image::fromFile(const char *file)
+static BitmapData decode(const unsigned char *data, const size_t size,
+  const BitmapData::MaxSize &maxSize)
+{
+  using boost::iostreams::array_source;
+  boost::iostreams::stream<array_source>
+    stream { reinterpret_cast<const char *>(data), size };
+  const Image::RegisterType &type { findType(stream) };
+
+  BitmapData bitmap;
+  if(type.m_decodeMemory)
+    type.m_decodeMemory(data, size, &bitmap, maxSize);
+  else
+    type.m_decode(stream, &bitmap, maxSize);
+  bitmap.shrink(maxSize);
+  return bitmap;
+}
+
+BitmapData BitmapData::fromFile(const char *file, const MaxSize &maxSize)
 {
+  if(const MappedFile mapping { file })
+    return decode(mapping.data(), mapping.size(), maxSize);
+
+  // also reports why the file could not be opened
   std::ifstream stream;
   stream.open(WIDEN(file), std::ios_base::binary);
   if(!stream.good())
     throw reascript_error { strerror(errno) };
-  return create(stream);
+  return fromStream(stream, maxSize);
 }
 
-Image *Image::fromMemory(const char *data, const int size)
+BitmapData BitmapData::fromMemory(const char *data, const int size,
+  const MaxSize &maxSize)
 {
-  using boost::iostreams::array_source;
-  boost::iostreams::stream<array_source> stream { data, size };
-  return create(stream);
+  return decode(reinterpret_cast<const unsigned char *>(data), size, maxSize);
 }
 
-const unsigned char *Bitmap::getPixels(
-  const Texture &texture, int *width, int *height)
+BitmapData BitmapData::fromStream(std::istream &stream, const MaxSize &maxSize)
 {
-  const Bitmap *image { static_cast<Bitmap *>(texture.object()) };
-  *width = image->m_width, *height = image->m_height;
-  return image->m_pixels.data();
+  const Image::RegisterType &type { findType(stream) };
+  BitmapData bitmap;
+  type.m_decode(stream, &bitmap, maxSize);
+  bitmap.shrink(maxSize);
+  return bitmap;
 }
 
-void Bitmap::resize(const int width, const int height, const int format)
+void BitmapData::MaxSize::fit(int *outWidth, int *outHeight) const
+{
+  double scale { 1.0 };
+  if(width > 0 && *outWidth > width)
+    scale = static_cast<double>(width) / *outWidth;
+  if(height > 0 && *outHeight > height)
+    scale = std::min(scale, static_cast<double>(height) / *outHeight);
+  if(scale == 1.0)
+    return;
+
+  *outWidth  = std::max(1, static_cast<int>(std::lround(*outWidth  * scale)));
+  *outHeight = std::max(1, static_cast<int>(std::lround(*outHeight * scale)));
+}
+
+BitmapData::BitmapData()
+  : m_width {}, m_height {}
+{
+}
+
+void BitmapData::resize(const int width, const int height, const int format,
+  const MaxSize &maxSize)
 try
 {
   constexpr int MAX_SIZE { 0x2000 }; // Direct3D10 Texture2D limit
 
   if(format != 4)
     throw reascript_error { "BUG: unexpected pixel format, missing transform?" };
-  if(height > MAX_SIZE || width > MAX_SIZE)
+  int fitWidth { width }, fitHeight { height };
+  maxSize.fit(&fitWidth, &fitHeight);
+  if(fitHeight > MAX_SIZE || fitWidth > MAX_SIZE)
     throw reascript_error { "image is too big" };
   m_width = width, m_height = height;
   m_pixels.resize(m_width * m_height * format);
@@ -91,7 +151,7 @@ catch(const std::bad_alloc &)
   throw reascript_error { "cannot allocate memory" };
 }
 
-std::vector<unsigned char *> Bitmap::makeScanlines()
+std::vector<unsigned char *> BitmapData::makeScanlines()
 {
   std::vector<unsigned char *> scanlines;
   scanlines.reserve(m_height);
@@ -101,9 +161,239 @@ std::vector<unsigned char *> Bitmap::makeScanlines()
   return scanlines;
 }
 
-size_t Bitmap::makeTexture(TextureManager *textureManager)
+void BitmapData::shrink(const MaxSize &maxSize)
+{
+  int width { static_cast<int>(m_width) }, height { static_cast<int>(m_height) };
+  maxSize.fit(&width, &height);
+  if(static_cast<size_t>(width) == m_width &&
+     static_cast<size_t>(height) == m_height)
+    return;
+
+  // source columns covered by each destination column
+  std::vector<size_t> columns(width + 1);
+  for(int x {}; x <= width; ++x)
+    columns[x] = (x * m_width) / width;
+
+  std::vector<unsigned char> pixels(static_cast<size_t>(width) * height * 4);
+  std::vector<uint64_t> sums(static_cast<size_t>(width) * 5);
+  unsigned char *out { pixels.data() };
+
+  for(int y {}; y < height; ++y) {
+    const size_t top { (y * m_height) / height },
+              bottom { ((y + 1) * m_height) / height };
+
+    std::fill(sums.begin(), sums.end(), 0);
+    for(size_t sy { top }; sy < bottom; ++sy) {
+      const unsigned char *row { &m_pixels[sy * m_width * 4] };
+      for(int x {}; x < width; ++x) {
+        uint64_t *sum { &sums[x * 5] };
+        for(size_t sx { columns[x] }; sx < columns[x + 1]; ++sx) {
+          const unsigned char *in { &row[sx * 4] };
+          // color weighted by alpha to not bleed from transparent pixels
+          sum[0] += in[0] * in[3];
+          sum[1] += in[1] * in[3];
+          sum[2] += in[2] * in[3];
+          sum[3] += in[3];
+          ++sum[4];
+        }
+      }
+    }
+
+    for(int x {}; x < width; ++x, out += 4) {
+      const uint64_t *sum { &sums[x * 5] }, alpha { sum[3] };
+      for(int c {}; c < 3; ++c)
+        out[c] = alpha ? (sum[c] + (alpha / 2)) / alpha : 0;
+      out[3] = (alpha + (sum[4] / 2)) / sum[4];
+    }
+  }
+
+  m_width = width, m_height = height;
+  m_pixels = std::move(pixels);
+}
+
+Image *Image::fromFile(const char *file, const BitmapData::MaxSize &maxSize,
+  const int flags)
+{
+  if(flags & ReaImGuiImageFlags_Cache)
+    return new Bitmap { ImageCache::get().load(file, maxSize) };
+  else
+    return new Bitmap { BitmapData::fromFile(file, maxSize) };
+}
+
+Image *Image::fromMemory(const char *data, const int size,
+  const BitmapData::MaxSize &maxSize)
+{
+  return new Bitmap { BitmapData::fromMemory(data, size, maxSize) };
+}
+
+static std::unordered_set<TextureShareId> g_bitmaps; // alive share IDs
+
+Bitmap::Bitmap()
+  : Bitmap { std::make_shared<const BitmapData>() }
+{
+}
+
+Bitmap::Bitmap(BitmapData &&data)
+  : Bitmap { std::make_shared<const BitmapData>(std::move(data)) }
 {
-  return textureManager->touch(this, 1.f, &getPixels, &Resource::isValid<void>);
+}
+
+Bitmap::Bitmap(std::shared_ptr<const BitmapData> data)
+  : m_data { std::move(data) }
+{
+  // unlike addresses, never reused by another image
+  static std::atomic<TextureShareId> nextShareId { 1 };
+  m_shareId = nextShareId++;
+  g_bitmaps.insert(m_shareId);
+}
+
+Bitmap::~Bitmap()
+{
+  g_bitmaps.erase(m_shareId);
+}
+
+bool Bitmap::isAlive(const TextureShareId shareId)
+{
+  return g_bitmaps.contains(shareId);
+}
+
+BitmapData *Bitmap::data()
+{
+  if(m_data.use_count() > 1)
+    m_data = std::make_shared<const BitmapData>(*m_data);
+
+  // the only owner
+  return const_cast<BitmapData *>(m_data.get());
+}
+
+const unsigned char *Bitmap::getPixels(
+  const Texture &texture, int *width, int *height)
+{
+  const Bitmap *image { static_cast<Bitmap *>(texture.object()) };
+  *width = image->width(), *height = image->height();
+  return image->pixels();
+}
+
+size_t Bitmap::makeTexture(Context *ctx, ImVec2 *uvs, const size_t uvCount)
+{
+  if(ImageAtlas *atlas { ctx->imageAtlas() }) {
+    if(const auto tex { atlas->makeTexture(this, uvs, uvCount) })
+      return *tex;
+  }
+
+  return ctx->textureManager()->touch(this, 1.f, &getPixels,
+    &Resource::isValid<void>, nullptr, m_shareId);
+}
+
+static const unsigned char *getPlaceholderPixels(const Texture &,
+  int *width, int *height)
+{
+  static const unsigned char transparent[4] {};
+  *width = *height = 1;
+  return transparent;
+}
+
+AsyncImage::AsyncImage(const char *file, const BitmapData::MaxSize &maxSize,
+    const int flags)
+  : m_job { std::make_shared<Job>() },
+    m_state { ReaImGuiImageState_Loading }
+{
+  m_job->state = ReaImGuiImageState_Loading;
+
+  // the job outlives this object if it is destroyed while loading
+  DecoderPool &decoder { DecoderPool::get() };
+  decoder.push([job = m_job, file = std::string { file }, maxSize, flags] {
+    try {
+      job->data = flags & ReaImGuiImageFlags_Cache
+        ? ImageCache::get().load(file.c_str(), maxSize)
+        : std::make_shared<const BitmapData>(
+            BitmapData::fromFile(file.c_str(), maxSize));
+      job->state = ReaImGuiImageState_Ready;
+    }
+    catch(const std::exception &e) {
+      job->error = e.what();
+      job->state = ReaImGuiImageState_Failed;
+    }
+  });
+}
+
+size_t AsyncImage::makeTexture(Context *ctx, ImVec2 *uvs, const size_t uvCount)
+{
+  if(m_state == ReaImGuiImageState_Ready)
+    return Bitmap::makeTexture(ctx, uvs, uvCount);
+
+  // not using this as the key to not upload the pixels once ready
+  static char placeholder;
+  return ctx->textureManager()->touch(&placeholder, 1.f, &getPlaceholderPixels);
+}
+
+bool AsyncImage::heartbeat()
+{
+  if(!Resource::heartbeat())
+    return false;
+
+  // images are only modified by the main thread
+  if(m_job && m_job->state != ReaImGuiImageState_Loading) {
+    m_state = m_job->state;
+    m_error = std::move(m_job->error);
+    if(m_job->data)
+      m_data = std::move(m_job->data);
+    m_job.reset();
+  }
+
+  return true;
+}
+
+PixelImage::PixelImage(const int width, const int height)
+{
+  if(width < 1 || height < 1)
+    throw reascript_error { "image size must be at least 1x1" };
+  resize(width, height, 4);
+}
+
+template<typename CopyRow>
+void PixelImage::update(const int x, const int y,
+  const int width, const int height, const CopyRow &copyRow)
+{
+  if(x < 0 || y < 0 || width < 1 || height < 1 ||
+      static_cast<size_t>(x) + width  > this->width() ||
+      static_cast<size_t>(y) + height > this->height())
+    throw reascript_error { "region is out of bounds" };
+
+  BitmapData *bitmap { data() };
+  std::vector<unsigned char *> scanlines { bitmap->makeScanlines() };
+  for(int row {}; row < height; ++row)
+    copyRow(row, scanlines[y + row] + (x * 4));
+
+  // only the changed region is uploaded again
+  const TextureCmd::Region region { x, y, x + width, y + height };
+  Resource::foreach<Context>([this, &region](Context *ctx) {
+    ctx->textureManager()->invalidate(this, region);
+    if(ImageAtlas *atlas { ctx->imageAtlas() })
+      atlas->update(this);
+  });
+}
+
+void PixelImage::update(const int x, const int y,
+  const int width, const int height, const unsigned char *rgba)
+{
+  const size_t rowSize { static_cast<size_t>(width) * 4 };
+  update(x, y, width, height, [rgba, rowSize](const int row, unsigned char *out) {
+    std::memcpy(out, rgba + (row * rowSize), rowSize);
+  });
+}
+
+void PixelImage::update(const int x, const int y,
+  const int width, const int height, const double *colors)
+{
+  update(x, y, width, height, [colors, width](const int row, unsigned char *out) {
+    const double *in { colors + (static_cast<size_t>(row) * width) };
+    for(int i {}; i < width; ++i, out += 4) {
+      // also accepts negative values from signed 32-bit integers
+      const uint32_t rgba { static_cast<uint32_t>(static_cast<int64_t>(in[i])) };
+      out[0] = rgba >> 24, out[1] = rgba >> 16, out[2] = rgba >> 8, out[3] = rgba;
+    }
+  });
 }
 
 void ImageSet::add(const float scale, Image *img)
@@ -150,9 +440,26 @@ size_t ImageSet::height() const
   return item.image->height() / item.scale;
 }
 
-size_t ImageSet::makeTexture(TextureManager *textureManager)
+size_t ImageSet::makeTexture(Context *ctx, ImVec2 *uvs, const size_t uvCount)
 {
-  return select().image->makeTexture(textureManager);
+  return select().image->makeTexture(ctx, uvs, uvCount);
+}
+
+ImageState ImageSet::state() const
+{
+  ImageState state { ReaImGuiImageState_Ready };
+  for(const auto &item : m_images)
+    state = std::max(state, item.image->state()); // Ready < Loading < Failed
+  return state;
+}
+
+std::string_view ImageSet::error() const
+{
+  for(const auto &item : m_images) {
+    if(item.image->state() == ReaImGuiImageState_Failed)
+      return item.image->error();
+  }
+  return {};
 }
 
 bool ImageSet::heartbeat()
@@ -22,29 +22,88 @@
 
 #include <vector>
 #include <istream>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <string_view>
 
 class Texture;
-class TextureManager;
+struct ImVec2;
+using TextureShareId = unsigned long long;
 
-class Image : public Resource {
+enum ImageFlags {
+  ReaImGuiImageFlags_None  = 0,
+  ReaImGuiImageFlags_Cache = 1<<0,
+};
+
+enum ImageState {
+  ReaImGuiImageState_Ready,
+  ReaImGuiImageState_Loading,
+  ReaImGuiImageState_Failed,
+};
+
+// Straight RGBA pixels. Unlike images, they may be decoded on any thread.
+class BitmapData {
 public:
-  struct RegisterType {
-    using TestFunc   = bool   (*)(std::istream &);
-    using CreateFunc = Image *(*)(std::istream &);
+  // largest size to decode at, preserving the aspect ratio
+  struct MaxSize {
+    int width, height; // 0 for no limit
+    void fit(int *width, int *height) const;
+  };
+
+  // memory-mapped if possible
+  static BitmapData fromFile(const char *, const MaxSize & = {});
+  static BitmapData fromMemory(const char *, int size, const MaxSize & = {});
+  static BitmapData fromStream(std::istream &, const MaxSize & = {});
+
+  BitmapData();
+
+  size_t width()  const { return m_width;  }
+  size_t height() const { return m_height; }
+  const unsigned char *pixels() const { return m_pixels.data(); }
+
+  // the size limit applies to the size once shrunk to the given maximum
+  void resize(int width, int height, int format, const MaxSize & = {});
+  std::vector<unsigned char *> makeScanlines();
+  // averages blocks of pixels (weighted by their alpha) to fit within max
+  void shrink(const MaxSize &);
 
-    RegisterType(TestFunc, CreateFunc);
+private:
+  std::vector<unsigned char> m_pixels;
+  size_t m_width, m_height;
+};
 
-    const TestFunc   m_test;
-    const CreateFunc m_create;
+class Image : public Resource {
+public:
+  struct RegisterType {
+    // the decoded size may be larger than the maximum, it is then shrunk
+    using TestFunc         = bool (*)(std::istream &);
+    using DecodeFunc       = void (*)(std::istream &, BitmapData *,
+                                      const BitmapData::MaxSize &);
+    // reads directly from the data instead of copying it through a stream
+    using DecodeMemoryFunc = void (*)(const unsigned char *, size_t,
+                                      BitmapData *, const BitmapData::MaxSize &);
+
+    RegisterType(TestFunc, DecodeFunc, DecodeMemoryFunc = nullptr);
+
+    const TestFunc         m_test;
+    const DecodeFunc       m_decode;
+    const DecodeMemoryFunc m_decodeMemory;
     const RegisterType * const m_next;
   };
 
-  static Image *fromFile(const char *);
-  static Image *fromMemory(const char *, int size);
+  static Image *fromFile(const char *, const BitmapData::MaxSize & = {},
+                         int flags = ReaImGuiImageFlags_None);
+  static Image *fromMemory(const char *, int size,
+                           const BitmapData::MaxSize & = {});
 
   virtual size_t width()  const = 0;
   virtual size_t height() const = 0;
-  virtual size_t makeTexture(TextureManager *) = 0;
+  // may remap the texture coordinates (eg. to the image's location in an atlas)
+  virtual size_t makeTexture(Context *, ImVec2 *uvs, size_t uvCount) = 0;
+  virtual ImageState state() const { return ReaImGuiImageState_Ready; }
+  // reason of the failure when the state is Failed
+  virtual std::string_view error() const { return {}; }
 
   bool attachable(const Context *) const override { return true; }
 };
@@ -52,23 +111,73 @@ public:
 using ImGui_Image = Image;
 API_REGISTER_OBJECT_TYPE(Image);
 
+// The pixels may be shared with other bitmaps, they are copied on write
 class Bitmap : public Image {
 public:
-  size_t width()  const override { return m_width;  }
-  size_t height() const override { return m_height; }
-  size_t makeTexture(TextureManager *) override;
+  Bitmap(BitmapData &&);
+  Bitmap(std::shared_ptr<const BitmapData>);
+  ~Bitmap();
+
+  // whether the bitmap identified by the share ID still exists
+  static bool isAlive(TextureShareId);
+
+  size_t width()  const override { return m_data->width();  }
+  size_t height() const override { return m_data->height(); }
+  size_t makeTexture(Context *, ImVec2 *uvs, size_t uvCount) override;
+
+  const unsigned char *pixels() const { return m_data->pixels(); }
+  // identifies the pixels across contexts and atlases
+  TextureShareId shareId() const { return m_shareId; }
 
 protected:
-  Bitmap() = default;
+  Bitmap();
 
-  void resize(int width, int height, int format);
-  std::vector<unsigned char *> makeScanlines();
+  BitmapData *data();
+  void resize(int width, int height, int format)
+    { data()->resize(width, height, format); }
+
+  std::shared_ptr<const BitmapData> m_data;
 
 private:
   static const unsigned char *getPixels(const Texture &, int *width, int *height);
 
-  std::vector<unsigned char> m_pixels;
-  size_t m_width, m_height;
+  TextureShareId m_shareId;
+};
+
+// Decoded in the background, drawn as transparent until ready
+class AsyncImage final : public Bitmap {
+public:
+  AsyncImage(const char *file, const BitmapData::MaxSize & = {},
+             int flags = ReaImGuiImageFlags_None);
+
+  size_t makeTexture(Context *, ImVec2 *uvs, size_t uvCount) override;
+  ImageState state() const override { return m_state; }
+  std::string_view error() const override { return m_error; }
+
+protected:
+  bool heartbeat() override;
+
+private:
+  struct Job; // shared with the decoding thread
+
+  std::shared_ptr<Job> m_job;
+  ImageState m_state;
+  std::string m_error;
+};
+
+// Pixels computed by the script, updated in place
+class PixelImage final : public Bitmap {
+public:
+  PixelImage(int width, int height); // transparent
+
+  // rows of straight RGBA pixels, tightly packed to the width of the region
+  void update(int x, int y, int width, int height, const unsigned char *rgba);
+  // one 0xRRGGBBAA color per pixel
+  void update(int x, int y, int width, int height, const double *colors);
+
+private:
+  template<typename CopyRow>
+  void update(int x, int y, int width, int height, const CopyRow &);
 };
 
 class ImageSet final : public Image {
@@ -77,7 +186,9 @@ public:
 
   size_t width() const override;
   size_t height() const override;
-  size_t makeTexture(TextureManager *) override;
+  size_t makeTexture(Context *, ImVec2 *uvs, size_t uvCount) override;
+  ImageState state() const override;
+  std::string_view error() const override; // of the first failed image
 
 protected:
   bool heartbeat() override;
@@ -100,4 +211,7 @@ private:
 using ImGui_ImageSet = ImageSet;
 API_REGISTER_OBJECT_TYPE(ImageSet);
 
+// encodes straight (non-premultiplied) RGBA pixels
+void writePNG(std::ostream &, const unsigned char *rgba, int width, int height);
+
 #endif
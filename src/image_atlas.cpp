@@ -0,0 +1,195 @@
+/* ReaImGui: ReaScript binding for Dear ImGui
+ * Copyright (C) 2021-2024  Christian Fillion
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "image_atlas.hpp"
+
+#include "image.hpp"
+#include "texture.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <imgui/imgui.h>
+
+// border of repeated edge pixels around each image to prevent linear
+// filtering from sampling its neighbors
+constexpr int PADDING { 1 };
+
+struct ImageAtlas::Page {
+  Page();
+
+  static const unsigned char *getPixels(const Texture &, int *width, int *height);
+  bool allocate(int width, int height, int *x, int *y);
+  void copy(const Bitmap *, int x, int y);
+
+  std::vector<unsigned char> pixels;
+  int shelfTop, shelfHeight, cursor; // naive shelf packing
+  unsigned int images;
+};
+
+ImageAtlas::Page::Page()
+  : pixels(PAGE_SIZE * PAGE_SIZE * 4),
+    shelfTop {}, shelfHeight {}, cursor {}, images {}
+{
+}
+
+const unsigned char *ImageAtlas::Page::getPixels(
+  const Texture &texture, int *width, int *height)
+{
+  const Page *page { static_cast<Page *>(texture.object()) };
+  *width = *height = PAGE_SIZE;
+  return page->pixels.data();
+}
+
+bool ImageAtlas::Page::allocate(const int width, const int height,
+  int *x, int *y)
+{
+  // the current shelf is only closed if the image fits in the next one
+  int left { cursor }, top { shelfTop }, rowHeight { shelfHeight };
+  if(left + width > PAGE_SIZE) {
+    top += rowHeight;
+    rowHeight = left = 0;
+  }
+  if(top + height > PAGE_SIZE)
+    return false;
+
+  *x = left, *y = top;
+  shelfTop = top;
+  cursor = left + width;
+  shelfHeight = std::max(rowHeight, height);
+  return true;
+}
+
+void ImageAtlas::Page::copy(const Bitmap *bitmap, const int x, const int y)
+{
+  const int width  { static_cast<int>(bitmap->width())  },
+            height { static_cast<int>(bitmap->height()) };
+  const unsigned char *source { bitmap->pixels() };
+
+  for(int row { -PADDING }; row < height + PADDING; ++row) {
+    const int sourceRow { std::clamp(row, 0, height - 1) };
+    const unsigned char *sourceLine { source + (sourceRow * width * 4) };
+    unsigned char *line
+      { pixels.data() + (((y + PADDING + row) * PAGE_SIZE) + x + PADDING) * 4 };
+
+    std::memcpy(line, sourceLine, width * 4);
+    for(int i { 1 }; i <= PADDING; ++i) {
+      std::memcpy(line - (i * 4), sourceLine, 4);
+      std::memcpy(line + ((width + i - 1) * 4), sourceLine + ((width - 1) * 4), 4);
+    }
+  }
+}
+
+ImageAtlas::ImageAtlas(TextureManager *textureManager)
+  : m_textureManager { textureManager }
+{
+}
+
+ImageAtlas::~ImageAtlas() = default;
+
+std::optional<size_t> ImageAtlas::makeTexture(const Bitmap *bitmap,
+  ImVec2 *uvs, const size_t count)
+{
+  const size_t width { bitmap->width() }, height { bitmap->height() };
+  if(!width || !height || width > MAX_IMAGE_SIZE || height > MAX_IMAGE_SIZE)
+    return std::nullopt;
+
+  // tiling requires a texture of its own
+  for(size_t i {}; i < count; ++i) {
+    if(uvs[i].x < 0.f || uvs[i].x > 1.f || uvs[i].y < 0.f || uvs[i].y > 1.f)
+      return std::nullopt;
+  }
+
+  auto it { m_slots.find(bitmap->shareId()) };
+  if(it == m_slots.end())
+    it = m_slots.emplace(bitmap->shareId(), place(bitmap)).first;
+
+  Slot &slot { it->second };
+  slot.lastTimeActive = ImGui::GetTime();
+
+  const ImVec2 offset { static_cast<float>(slot.x + PADDING),
+                        static_cast<float>(slot.y + PADDING) };
+  for(size_t i {}; i < count; ++i) {
+    uvs[i].x = (offset.x + (uvs[i].x * width))  / PAGE_SIZE;
+    uvs[i].y = (offset.y + (uvs[i].y * height)) / PAGE_SIZE;
+  }
+
+  return m_textureManager->touch(slot.page, 1.f, &Page::getPixels);
+}
+
+void ImageAtlas::update(const Bitmap *bitmap)
+{
+  const auto it { m_slots.find(bitmap->shareId()) };
+  if(it == m_slots.end())
+    return;
+
+  const Slot &slot { it->second };
+  const int width  { static_cast<int>(bitmap->width())  + (PADDING * 2) },
+            height { static_cast<int>(bitmap->height()) + (PADDING * 2) };
+  slot.page->copy(bitmap, slot.x, slot.y);
+  m_textureManager->invalidate(slot.page,
+    { slot.x, slot.y, slot.x + width, slot.y + height });
+}
+
+ImageAtlas::Slot ImageAtlas::place(const Bitmap *bitmap)
+{
+  const int width  { static_cast<int>(bitmap->width())  + (PADDING * 2) },
+            height { static_cast<int>(bitmap->height()) + (PADDING * 2) };
+
+  Slot slot {};
+  const auto page { std::find_if(m_pages.begin(), m_pages.end(),
+    [&](const auto &page) {
+      return page->allocate(width, height, &slot.x, &slot.y);
+    }) };
+
+  if(page == m_pages.end()) {
+    slot.page = m_pages.emplace_back(std::make_unique<Page>()).get();
+    slot.page->allocate(width, height, &slot.x, &slot.y);
+    slot.page->copy(bitmap, slot.x, slot.y);
+  }
+  else {
+    slot.page = page->get();
+    slot.page->copy(bitmap, slot.x, slot.y);
+    m_textureManager->invalidate(slot.page,
+      { slot.x, slot.y, slot.x + width, slot.y + height });
+  }
+
+  ++slot.page->images;
+  return slot;
+}
+
+void ImageAtlas::cleanup()
+{
+  const float ttl { ImGui::GetIO().ConfigMemoryCompactTimer };
+  const auto cutoff { static_cast<float>(ImGui::GetTime()) - ttl };
+
+  for(auto it { m_slots.begin() }; it != m_slots.end();) {
+    if(Bitmap::isAlive(it->first) && it->second.lastTimeActive > cutoff)
+      ++it;
+    else {
+      --it->second.page->images;
+      it = m_slots.erase(it);
+    }
+  }
+
+  // space freed by removed images is only reclaimed once their page is empty
+  std::erase_if(m_pages, [this](const auto &page) {
+    if(page->images)
+      return false;
+    m_textureManager->remove(page.get());
+    return true;
+  });
+}
@@ -0,0 +1,64 @@
+/* ReaImGui: ReaScript binding for Dear ImGui
+ * Copyright (C) 2021-2024  Christian Fillion
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef REAIMGUI_IMAGE_ATLAS_HPP
+#define REAIMGUI_IMAGE_ATLAS_HPP
+
+#include <memory>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+
+class Bitmap;
+class Texture;
+class TextureManager;
+struct ImVec2;
+using TextureShareId = unsigned long long;
+
+// Packs small images into shared textures so that consecutive images
+// can be drawn using a single draw command.
+class ImageAtlas {
+public:
+  static constexpr int PAGE_SIZE { 512 }, MAX_IMAGE_SIZE { 64 };
+
+  ImageAtlas(TextureManager *);
+  ~ImageAtlas();
+
+  // remaps the texture coordinates to the image's location in the atlas
+  // returns nullopt if the image must use its own texture instead
+  std::optional<size_t> makeTexture(const Bitmap *, ImVec2 *uvs, size_t count);
+  // copies the pixels of a modified image placed in the atlas again
+  void update(const Bitmap *);
+  void cleanup();
+
+private:
+  struct Page;
+  struct Slot {
+    Page *page;
+    int x, y;
+    float lastTimeActive;
+  };
+
+  Slot place(const Bitmap *);
+
+  TextureManager *m_textureManager;
+  std::vector<std::unique_ptr<Page>> m_pages;
+  // keyed by share ID as the address of a freed image may be reused
+  std::unordered_map<TextureShareId, Slot> m_slots;
+};
+
+#endif
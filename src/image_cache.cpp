@@ -0,0 +1,155 @@
+/* ReaImGui: ReaScript binding for Dear ImGui
+ * Copyright (C) 2021-2024  Christian Fillion
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "image_cache.hpp"
+
+#include "win32_unicode.hpp"
+
+#include <algorithm>
+
+#ifdef _WIN32
+#  include <windows.h>
+#else
+#  include <cstdlib> // realpath, free
+#  include <sys/stat.h>
+#endif
+
+struct FileStamp {
+  std::string path; // canonical
+  long long mtime;
+  unsigned long long size;
+};
+
+static bool stampFile(const char *file, FileStamp *stamp)
+{
+#ifdef _WIN32
+  HANDLE handle { CreateFileW(WIDEN(file), FILE_READ_ATTRIBUTES,
+    FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+    nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr) };
+  if(handle == INVALID_HANDLE_VALUE)
+    return false;
+
+  BY_HANDLE_FILE_INFORMATION info;
+  std::wstring path(GetFinalPathNameByHandleW(handle, nullptr, 0, 0), L'\0');
+  const bool ok { !path.empty() && GetFileInformationByHandle(handle, &info) &&
+    GetFinalPathNameByHandleW(handle, path.data(), path.size(), 0) };
+  CloseHandle(handle);
+  if(!ok)
+    return false;
+
+  path.pop_back(); // null terminator
+  stamp->path  = narrow(path);
+  stamp->mtime = (static_cast<long long>(info.ftLastWriteTime.dwHighDateTime) << 32) |
+                 info.ftLastWriteTime.dwLowDateTime;
+  stamp->size  = (static_cast<unsigned long long>(info.nFileSizeHigh) << 32) |
+                 info.nFileSizeLow;
+#else
+  struct stat info;
+  if(stat(file, &info) || !S_ISREG(info.st_mode))
+    return false;
+
+  char *path { realpath(file, nullptr) };
+  if(!path)
+    return false;
+  stamp->path = path;
+  free(path);
+
+#  ifdef __APPLE__
+  const auto &mtime { info.st_mtimespec };
+#  else
+  const auto &mtime { info.st_mtim };
+#  endif
+  stamp->mtime = (mtime.tv_sec * 1'000'000'000LL) + mtime.tv_nsec;
+  stamp->size  = info.st_size;
+#endif
+
+  return true;
+}
+
+static size_t byteSize(const BitmapData &data)
+{
+  return data.width() * data.height() * 4;
+}
+
+ImageCache &ImageCache::get()
+{
+  static ImageCache cache;
+  return cache;
+}
+
+ImageCache::ImageCache(const size_t budget)
+  : m_budget { budget }, m_bytes {}, m_hits {}, m_misses {}, m_clock {}
+{
+}
+
+ImageCache::Data ImageCache::load(const char *file,
+  const BitmapData::MaxSize &maxSize)
+{
+  FileStamp stamp;
+  if(!stampFile(file, &stamp)) // let the decoder report why
+    return std::make_shared<const BitmapData>(BitmapData::fromFile(file, maxSize));
+
+  Key key { std::move(stamp.path),
+    std::max(0, maxSize.width), std::max(0, maxSize.height) };
+
+  {
+    std::lock_guard<std::mutex> lock { m_mutex };
+    const auto it { m_entries.find(key) };
+    if(it != m_entries.end() &&
+        it->second.mtime == stamp.mtime && it->second.size == stamp.size) {
+      ++m_hits;
+      it->second.lastUse = ++m_clock;
+      return it->second.data;
+    }
+    ++m_misses;
+  }
+
+  // decoding without holding the lock, concurrent misses may decode twice
+  Data data {
+    std::make_shared<const BitmapData>(BitmapData::fromFile(file, maxSize))
+  };
+
+  std::lock_guard<std::mutex> lock { m_mutex };
+  Entry &entry { m_entries[std::move(key)] };
+  if(entry.data)
+    m_bytes -= byteSize(*entry.data);
+  entry = { stamp.mtime, stamp.size, data, ++m_clock };
+  m_bytes += byteSize(*data);
+  evictOverBudget();
+
+  return data;
+}
+
+void ImageCache::evictOverBudget()
+{
+  // images still in use keep their pixels until they are destroyed
+  while(m_bytes > m_budget && !m_entries.empty()) {
+    const auto lru { std::min_element(m_entries.begin(), m_entries.end(),
+      [](const auto &a, const auto &b) {
+        return a.second.lastUse < b.second.lastUse;
+      }) };
+    m_bytes -= byteSize(*lru->second.data);
+    m_entries.erase(lru);
+  }
+}
+
+ImageCache::Stats ImageCache::stats() const
+{
+  std::lock_guard<std::mutex> lock { m_mutex };
+  return { m_hits, m_misses, m_entries.size(), m_bytes };
+}
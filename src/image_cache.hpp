@@ -0,0 +1,74 @@
+/* ReaImGui: ReaScript binding for Dear ImGui
+ * Copyright (C) 2021-2024  Christian Fillion
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef REAIMGUI_IMAGE_CACHE_HPP
+#define REAIMGUI_IMAGE_CACHE_HPP
+
+#include "image.hpp"
+
+#include <map>
+#include <memory>
+#include <mutex>
+
+// Decoded images shared by all contexts and script instances. Entries are
+// keyed by the canonical path, modification time and size of the file and
+// evicted from the least recently used once over the memory budget.
+class ImageCache {
+public:
+  using Data = std::shared_ptr<const BitmapData>;
+
+  struct Stats {
+    unsigned int hits, misses; // since startup
+    size_t images, bytes;
+  };
+
+  static constexpr size_t DEFAULT_BUDGET { 128 << 20 };
+
+  static ImageCache &get();
+
+  ImageCache(size_t budget = DEFAULT_BUDGET);
+  ImageCache(const ImageCache &) = delete;
+
+  // thread-safe, decodes the file if it is not cached or was modified
+  Data load(const char *file, const BitmapData::MaxSize & = {});
+  Stats stats() const;
+
+private:
+  struct Key {
+    std::string path;
+    int maxWidth, maxHeight;
+    auto operator<=>(const Key &) const = default;
+  };
+
+  struct Entry {
+    long long mtime;
+    unsigned long long size;
+    Data data;
+    unsigned long long lastUse;
+  };
+
+  void evictOverBudget();
+
+  mutable std::mutex m_mutex;
+  std::map<Key, Entry> m_entries;
+  size_t m_budget, m_bytes;
+  unsigned int m_hits, m_misses;
+  unsigned long long m_clock;
+};
+
+#endif
@@ -0,0 +1,114 @@
+/* ReaImGui: ReaScript binding for Dear ImGui
+ * Copyright (C) 2021-2024  Christian Fillion
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "job_queue.hpp"
+
+#include <algorithm>
+
+JobQueue::JobQueue(const unsigned int threads, const Pending pending)
+  : m_submitted { 0 }, m_pending { pending }, m_quit { false }
+{
+  m_threads.reserve(threads);
+  for(unsigned int i {}; i < threads; ++i)
+    m_threads.emplace_back(&JobQueue::work, this);
+}
+
+JobQueue::~JobQueue()
+{
+  {
+    std::lock_guard<std::mutex> lock { m_mutex };
+    if(m_pending == Pending::Discard)
+      m_queue.clear();
+    m_quit = true;
+  }
+  m_wake.notify_all();
+
+  for(std::thread &thread : m_threads)
+    thread.join();
+}
+
+JobQueue::Ticket JobQueue::push(Job &&job)
+{
+  Ticket ticket;
+  {
+    std::lock_guard<std::mutex> lock { m_mutex };
+    ticket = ++m_submitted;
+    m_queue.emplace_back(ticket, std::move(job));
+  }
+  m_wake.notify_one();
+  return ticket;
+}
+
+bool JobQueue::runOne()
+{
+  std::unique_lock<std::mutex> lock { m_mutex };
+  if(m_queue.empty())
+    return false;
+
+  runFront(lock);
+  return true;
+}
+
+void JobQueue::wait(const Ticket ticket) const
+{
+  std::unique_lock<std::mutex> lock { m_mutex };
+  m_done.wait(lock, [this, ticket] { return isDone(ticket); });
+}
+
+void JobQueue::waitAll() const
+{
+  std::unique_lock<std::mutex> lock { m_mutex };
+  const Ticket last { m_submitted };
+  m_done.wait(lock, [this, last] { return isDone(last); });
+}
+
+bool JobQueue::isDone(const Ticket ticket) const
+{
+  // jobs may complete out of order when there are multiple threads
+  if(!m_queue.empty() && m_queue.front().first <= ticket)
+    return false;
+  return std::none_of(m_running.begin(), m_running.end(),
+    [ticket](const Ticket running) { return running <= ticket; });
+}
+
+void JobQueue::work()
+{
+  std::unique_lock<std::mutex> lock { m_mutex };
+
+  while(true) {
+    m_wake.wait(lock, [this] { return m_quit || !m_queue.empty(); });
+    if(m_queue.empty())
+      return; // quitting
+
+    runFront(lock);
+  }
+}
+
+void JobQueue::runFront(std::unique_lock<std::mutex> &lock)
+{
+  const auto [ticket, job] { std::move(m_queue.front()) };
+  m_queue.pop_front();
+  m_running.push_back(ticket);
+
+  lock.unlock();
+  job();
+  lock.lock();
+
+  std::erase(m_running, ticket);
+  m_done.notify_all();
+}
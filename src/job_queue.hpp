@@ -0,0 +1,67 @@
+/* ReaImGui: ReaScript binding for Dear ImGui
+ * Copyright (C) 2021-2024  Christian Fillion
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef REAIMGUI_JOB_QUEUE_HPP
+#define REAIMGUI_JOB_QUEUE_HPP
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Executes jobs on background threads, starting them in submission order
+class JobQueue {
+public:
+  using Job    = std::function<void ()>;
+  using Ticket = unsigned long long; // 0 = no job
+
+  // what to do with the jobs that have not started when destroyed
+  enum class Pending { Run, Discard };
+
+  JobQueue(unsigned int threads, Pending = Pending::Run);
+  JobQueue(const JobQueue &) = delete;
+  ~JobQueue();
+
+  // jobs must not throw
+  Ticket push(Job &&);
+  // executes the next job on the calling thread, false if there was none
+  bool runOne();
+  // blocks until the job and those submitted before it have returned
+  void wait(Ticket) const;
+  // blocks until every job submitted so far has returned
+  void waitAll() const;
+  size_t size() const { return m_threads.size(); }
+
+private:
+  void work();
+  void runFront(std::unique_lock<std::mutex> &);
+  bool isDone(Ticket) const; // with m_mutex held
+
+  mutable std::mutex m_mutex;
+  mutable std::condition_variable m_wake, m_done;
+  std::deque<std::pair<Ticket, Job>> m_queue;
+  std::vector<Ticket> m_running;
+  Ticket m_submitted;
+  Pending m_pending;
+  bool m_quit;
+  std::vector<std::thread> m_threads; // started last
+};
+
+#endif
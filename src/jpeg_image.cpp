@@ -27,11 +27,6 @@
 #include <jpeglib.h>
 #include <jerror.h>
 
-class JPEGImage final : public Bitmap {
-public:
-  JPEGImage(std::istream &);
-};
-
 static bool isJPEG(std::istream &stream)
 {
   constexpr const unsigned char jpeg[] { 0xFF, 0xD8, 0xFF };
@@ -40,12 +35,11 @@ static bool isJPEG(std::istream &stream)
   return memcmp(jpeg, magic, sizeof(jpeg)) == 0;
 }
 
-static Image *create(std::istream &stream)
-{
-  return new JPEGImage(stream);
-}
+static void decode(std::istream &, BitmapData *, const BitmapData::MaxSize &);
+static void decodeMemory(const unsigned char *, size_t, BitmapData *,
+  const BitmapData::MaxSize &);
 
-static const Image::RegisterType JPEG { &isJPEG, &create };
+static const Image::RegisterType JPEG { &isJPEG, &decode, &decodeMemory };
 
 static void error(j_common_ptr jpeg)
 {
@@ -108,7 +102,27 @@ void StreamSource::skip(j_decompress_ptr jpeg, long bytes)
   src->bytes_in_buffer -= bytes;
 }
 
-JPEGImage::JPEGImage(std::istream &stream)
+// picks the smallest DCT scaling (N/8) giving at least the wanted size
+static void setScale(jpeg_decompress_struct *jpeg,
+  const BitmapData::MaxSize &maxSize)
+{
+  int width  { static_cast<int>(jpeg->image_width)  },
+      height { static_cast<int>(jpeg->image_height) };
+  maxSize.fit(&width, &height);
+
+  constexpr unsigned int DENOM { 8 };
+  jpeg->scale_denom = DENOM;
+  for(jpeg->scale_num = 1; jpeg->scale_num < DENOM; ++jpeg->scale_num) {
+    jpeg_calc_output_dimensions(jpeg);
+    if(jpeg->output_width  >= static_cast<unsigned int>(width) &&
+       jpeg->output_height >= static_cast<unsigned int>(height))
+      break;
+  }
+}
+
+template<typename SetSource>
+static void decompress(BitmapData *bitmap, const BitmapData::MaxSize &maxSize,
+  const SetSource &setSource)
 {
   struct JPEG {
     ~JPEG() { jpeg_destroy_decompress(&info); }
@@ -123,14 +137,15 @@ JPEGImage::JPEGImage(std::istream &stream)
   err.output_message = error; // warnings as errors
 
   jpeg_create_decompress(jpeg);
-  StreamSource src { stream };
-  jpeg->src = &src;
+  setSource(jpeg);
   jpeg_read_header(jpeg, TRUE);
   jpeg->out_color_space = JCS_EXT_RGBA; // TODO: save memory with RGB textures
+  setScale(jpeg, maxSize);
   jpeg_start_decompress(jpeg);
 
-  resize(jpeg->output_width, jpeg->output_height, jpeg->output_components);
-  std::vector<unsigned char *> scanlines { makeScanlines() };
+  bitmap->resize(jpeg->output_width, jpeg->output_height,
+                 jpeg->output_components, maxSize);
+  std::vector<unsigned char *> scanlines { bitmap->makeScanlines() };
 
   // jpeg_read_scanlines does not decompress the entire image at once
   while(jpeg->output_scanline < jpeg->output_height) {
@@ -140,3 +155,19 @@ JPEGImage::JPEGImage(std::istream &stream)
 
   jpeg_finish_decompress(jpeg);
 }
+
+static void decode(std::istream &stream, BitmapData *bitmap,
+  const BitmapData::MaxSize &maxSize)
+{
+  StreamSource src { stream };
+  decompress(bitmap, maxSize,
+    [&src](j_decompress_ptr jpeg) { jpeg->src = &src; });
+}
+
+static void decodeMemory(const unsigned char *data, const size_t size,
+  BitmapData *bitmap, const BitmapData::MaxSize &maxSize)
+{
+  decompress(bitmap, maxSize, [data, size](j_decompress_ptr jpeg) {
+    jpeg_mem_src(jpeg, data, size); // reads the data in place
+  });
+}
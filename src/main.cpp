@@ -23,6 +23,7 @@
 
 #include "action.hpp"
 #include "api.hpp"
+#include "decoder_pool.hpp"
 #include "docker.hpp"
 #include "function.hpp"
 #include "resource.hpp"
@@ -141,6 +142,7 @@ extern "C" REAPER_PLUGIN_DLL_EXPORT int REAPER_PLUGIN_ENTRYPOINT(
   if(!rec) {
     API::teardown();
     Resource::destroyAll(); // save context settings
+    DecoderPool::teardown();
     Settings::teardown();
     Action::teardown();
     return 0;
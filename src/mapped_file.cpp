@@ -0,0 +1,89 @@
+/* ReaImGui: ReaScript binding for Dear ImGui
+ * Copyright (C) 2021-2024  Christian Fillion
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "mapped_file.hpp"
+
+#include "win32_unicode.hpp"
+
+#include <cstdint> // SIZE_MAX
+
+#ifdef _WIN32
+#  include <windows.h>
+#else
+#  include <fcntl.h>
+#  include <sys/mman.h>
+#  include <sys/stat.h>
+#  include <unistd.h>
+#endif
+
+MappedFile::MappedFile(const char *path)
+  : m_data { nullptr }, m_size { 0 }
+{
+#ifdef _WIN32
+  HANDLE file { CreateFileW(WIDEN(path), GENERIC_READ, FILE_SHARE_READ,
+    nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr) };
+  if(file == INVALID_HANDLE_VALUE)
+    return;
+
+  LARGE_INTEGER size;
+  HANDLE mapping {};
+  if(GetFileSizeEx(file, &size) && size.QuadPart > 0 &&
+      static_cast<unsigned long long>(size.QuadPart) <= SIZE_MAX)
+    mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+  CloseHandle(file); // the mapping keeps a reference to the file
+  if(!mapping)
+    return;
+
+  void *view { MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) };
+  CloseHandle(mapping); // the view keeps a reference to the mapping
+  if(!view)
+    return;
+
+  m_data = static_cast<const unsigned char *>(view);
+  m_size = size.QuadPart;
+#else
+  const int fd { open(path, O_RDONLY | O_CLOEXEC) };
+  if(fd < 0)
+    return;
+
+  struct stat info;
+  void *view { MAP_FAILED };
+  if(!fstat(fd, &info) && S_ISREG(info.st_mode) && info.st_size > 0)
+    view = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd); // the mapping keeps a reference to the file
+  if(view == MAP_FAILED)
+    return;
+
+  // the decoders read the file once from the start to the end
+  madvise(view, info.st_size, MADV_SEQUENTIAL);
+
+  m_data = static_cast<const unsigned char *>(view);
+  m_size = info.st_size;
+#endif
+}
+
+MappedFile::~MappedFile()
+{
+  if(!m_data)
+    return;
+
+#ifdef _WIN32
+  UnmapViewOfFile(m_data);
+#else
+  munmap(const_cast<unsigned char *>(m_data), m_size);
+#endif
+}
@@ -0,0 +1,39 @@
+/* ReaImGui: ReaScript binding for Dear ImGui
+ * Copyright (C) 2021-2024  Christian Fillion
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef REAIMGUI_MAPPED_FILE_HPP
+#define REAIMGUI_MAPPED_FILE_HPP
+
+#include <cstddef>
+
+// Read-only view of the whole content of a file
+class MappedFile {
+public:
+  MappedFile(const char *path); // invalid if the file cannot be mapped
+  MappedFile(const MappedFile &) = delete;
+  ~MappedFile();
+
+  operator bool() const { return m_data != nullptr; }
+  const unsigned char *data() const { return m_data; }
+  size_t size() const { return m_size; }
+
+private:
+  const unsigned char *m_data;
+  size_t m_size;
+};
+
+#endif
@@ -186,6 +186,23 @@ void MetalRenderer::Shared::textureCommand(const TextureCmd &cmd)
     break;
   case TextureCmd::Update:
     break;
+  case TextureCmd::UpdateRegion: {
+    const TextureCmd::Region &region { cmd.region };
+    for(size_t i {}; i < cmd.size; ++i) {
+      int width, height;
+      const unsigned char *pixels { cmd[i].getPixels(&width, &height) };
+      pixels += ((region.top * width) + region.left) * 4;
+      [m_textures[cmd.offset + i]
+        replaceRegion:MTLRegionMake2D(region.left, region.top,
+                                      region.right - region.left,
+                                      region.bottom - region.top)
+          mipmapLevel:0
+            withBytes:pixels
+          bytesPerRow:width * 4];
+    }
+    cmd.manager->addUploads(cmd.size);
+    return;
+  }
   case TextureCmd::Remove:
     m_textures.erase(m_textures.begin() + cmd.offset,
                      m_textures.begin() + cmd.offset + cmd.size);
@@ -218,6 +235,8 @@ void MetalRenderer::Shared::textureCommand(const TextureCmd &cmd)
                bytesPerRow:width * 4];
     m_textures[cmd.offset + i] = texture;
   }
+
+  cmd.manager->addUploads(cmd.size);
 }
 
 MetalRenderer::MetalRenderer(RendererFactory *factory, Window *window)
@@ -283,8 +302,13 @@ void MetalRenderer::render(void *)
 
   const ImGuiViewport *viewport { m_window->viewport() };
   const ImDrawData *drawData { viewport->DrawData };
-  const ImVec2 position { drawData->DisplayPos },
-               scale    { viewport->DpiScale, viewport->DpiScale };
+  const ImVec2 scale { viewport->DpiScale, viewport->DpiScale };
+
+  // only on or off (waiting for more than one vertical blank isn't supported)
+  if(@available(macOS 10.13, *)) {
+    if(const int interval { swapInterval() }; interval >= 0)
+      m_layer.displaySyncEnabled = interval > 0;
+  }
 
   id<CAMetalDrawable> drawable {};
   if(m_firstFrame) {
@@ -305,6 +329,7 @@ void MetalRenderer::render(void *)
   if(!drawable) {
     // execute queued texture operations even when the window is occluded
     [[m_shared->m_commandQueue commandBuffer] commit];
+    invalidate(); // nothing was presented
     return;
   }
 
@@ -346,32 +371,32 @@ void MetalRenderer::render(void *)
     memcpy(static_cast<char *>(m_buffers[IndexBuf].contents) + idxOffset,
       cmdList->IdxBuffer.Data, cmdList->IdxBuffer.Size * sizeof(ImDrawIdx));
 
-    for(int j {}; j < cmdList->CmdBuffer.Size; ++j) {
-      const ImDrawCmd *cmd { &cmdList->CmdBuffer[j] };
-      if(cmd->UserCallback)
-        continue; // no need to call the callback, not using them
+    vtxOffset += cmdList->VtxBuffer.Size * sizeof(ImDrawVert);
+    idxOffset += cmdList->IdxBuffer.Size * sizeof(ImDrawIdx);
+  }
 
-      const ClipRect clipRect { cmd->ClipRect, position, scale };
-      if(!clipRect)
-        continue;
+  vtxOffset = 0;
+  for(const DrawBatch::Call &call : batchDrawCalls(drawData, scale)) {
+    const ClipRect &clipRect { call.clipRect };
+    if(call.setClipRect) {
       [commandEncoder setScissorRect:MTLScissorRect {
         .x      = static_cast<NSUInteger>(clipRect.left),
         .y      = static_cast<NSUInteger>(clipRect.top),
         .width  = static_cast<NSUInteger>(clipRect.right - clipRect.left),
         .height = static_cast<NSUInteger>(clipRect.bottom - clipRect.top),
       }];
-
-      [commandEncoder setFragmentTexture:m_shared->m_textures[cmd->GetTexID()] atIndex:0];
-      [commandEncoder setVertexBufferOffset:vtxOffset + (cmd->VtxOffset * sizeof(ImDrawVert)) atIndex:0];
-      [commandEncoder drawIndexedPrimitives:MTLPrimitiveTypeTriangle
-                                 indexCount:cmd->ElemCount
-                                  indexType:sizeof(ImDrawIdx) == 2 ? MTLIndexTypeUInt16 : MTLIndexTypeUInt32
-                                indexBuffer:m_buffers[IndexBuf]
-                          indexBufferOffset:idxOffset + (cmd->IdxOffset * sizeof(ImDrawIdx))];
     }
-
-    vtxOffset += cmdList->VtxBuffer.Size * sizeof(ImDrawVert);
-    idxOffset += cmdList->IdxBuffer.Size * sizeof(ImDrawIdx);
+    if(call.setTexture)
+      [commandEncoder setFragmentTexture:m_shared->m_textures[call.texture] atIndex:0];
+    if(call.vtxOffset * sizeof(ImDrawVert) != vtxOffset) {
+      vtxOffset = call.vtxOffset * sizeof(ImDrawVert);
+      [commandEncoder setVertexBufferOffset:vtxOffset atIndex:0];
+    }
+    [commandEncoder drawIndexedPrimitives:MTLPrimitiveTypeTriangle
+                               indexCount:call.elemCount
+                                indexType:sizeof(ImDrawIdx) == 2 ? MTLIndexTypeUInt16 : MTLIndexTypeUInt32
+                              indexBuffer:m_buffers[IndexBuf]
+                        indexBufferOffset:call.idxOffset * sizeof(ImDrawIdx)];
   }
 
   [commandEncoder endEncoding];
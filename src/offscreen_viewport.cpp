@@ -0,0 +1,114 @@
+/* ReaImGui: ReaScript binding for Dear ImGui
+ * Copyright (C) 2021-2024  Christian Fillion
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "offscreen_viewport.hpp"
+
+#include "context.hpp"
+#include "error.hpp"
+#include "font.hpp"
+#include "image.hpp"
+#include "win32_unicode.hpp"
+
+#include <cstring> // strerror
+#include <fstream>
+
+OffscreenViewport *OffscreenViewport::get(ImGuiViewport *viewport)
+{
+  auto instance { static_cast<Viewport *>(viewport->PlatformUserData) };
+  return dynamic_cast<OffscreenViewport *>(instance);
+}
+
+OffscreenViewport::OffscreenViewport(ImGuiViewport *viewport,
+    const TextureManager *textureManager, const bool renderThread)
+  : Viewport { viewport }, m_textureManager { textureManager },
+    m_pos { viewport->Pos }, m_size { viewport->Size }, m_focus { false },
+    m_frame { 0 }
+{
+  m_viewport->DpiScale = scaleFactor();
+
+  if(renderThread)
+    m_renderThread = RenderThread::get();
+}
+
+OffscreenViewport::~OffscreenViewport()
+{
+  sync();
+}
+
+void OffscreenViewport::onChanged()
+{
+  if(m_ctx)
+    m_ctx->fonts().setScale(m_viewport->DpiScale);
+}
+
+void OffscreenViewport::render(void *)
+{
+  // the textures and the snapshot are in use until the previous frame is done
+  sync();
+  m_textures.update(m_textureManager);
+
+  const float scale { m_viewport->DpiScale };
+  const bool clear { !(m_viewport->Flags & ImGuiViewportFlags_NoRendererClear) };
+
+  if(!m_renderThread) {
+    rasterize(m_viewport->DrawData, scale, clear);
+    return;
+  }
+
+  m_snapshot.copy(m_viewport->DrawData);
+  m_frame = m_renderThread->push([this, scale, clear] {
+    rasterize(m_snapshot.get(), scale, clear);
+  });
+}
+
+void OffscreenViewport::rasterize(const ImDrawData *drawData,
+  const float scale, const bool clear)
+{
+  m_rasterizer.resize(drawData->DisplaySize.x * scale,
+                      drawData->DisplaySize.y * scale);
+  if(clear)
+    m_rasterizer.clear();
+  m_rasterizer.setTransform(drawData->DisplayPos, scale);
+
+  m_drawBatch.build(drawData, ImVec2(scale, scale));
+  m_rasterizer.draw(drawData, m_drawBatch, m_textures);
+}
+
+void OffscreenViewport::sync() const
+{
+  if(m_renderThread)
+    m_renderThread->wait(m_frame);
+}
+
+std::vector<unsigned char> OffscreenViewport::capture() const
+{
+  sync();
+  std::vector<unsigned char> rgba
+    (static_cast<size_t>(m_rasterizer.width()) * m_rasterizer.height() * 4);
+  m_rasterizer.readPixels(rgba.data());
+  return rgba;
+}
+
+void OffscreenViewport::writePNG(const char *filename) const
+{
+  std::ofstream stream;
+  stream.open(WIDEN(filename), std::ios_base::binary);
+  if(!stream.good())
+    throw reascript_error { strerror(errno) };
+
+  ::writePNG(stream, capture().data(), width(), height());
+}
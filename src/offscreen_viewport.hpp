@@ -0,0 +1,82 @@
+/* ReaImGui: ReaScript binding for Dear ImGui
+ * Copyright (C) 2021-2024  Christian Fillion
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef REAIMGUI_OFFSCREEN_VIEWPORT_HPP
+#define REAIMGUI_OFFSCREEN_VIEWPORT_HPP
+
+#include "viewport.hpp"
+
+#include "render_thread.hpp"
+#include "software_renderer.hpp"
+
+#include <imgui/imgui.h>
+
+class TextureManager;
+
+// Viewport without a native window for headless contexts.
+// Frames are rasterized on the CPU and kept in memory for capture.
+// With a render thread, rasterization runs from a copy of the draw data while
+// the next frame is built.
+class OffscreenViewport final : public Viewport {
+public:
+  static OffscreenViewport *get(ImGuiViewport *);
+
+  OffscreenViewport(ImGuiViewport *, const TextureManager *,
+    bool renderThread = false);
+  ~OffscreenViewport();
+
+  void create() override {}
+  void destroy() override {}
+  HWND nativeHandle() const override { return nullptr; }
+  void show() override {}
+  void setPosition(ImVec2 pos) override { m_pos = pos; }
+  ImVec2 getPosition() const override { return m_pos; }
+  void setSize(ImVec2 size) override { m_size = size; }
+  ImVec2 getSize() const override { return m_size; }
+  void setFocus() override { m_focus = true; }
+  bool hasFocus() const override { return m_focus; }
+  bool isMinimized() const override { return false; }
+  void setTitle(const char *) override {}
+  void setAlpha(float) override {}
+  void update() override {}
+  float scaleFactor() const override { return 1.f; }
+  void onChanged() override;
+  void setIME(ImGuiPlatformImeData *) override {}
+  void render(void *) override;
+
+  int width()  const { sync(); return m_rasterizer.width();  }
+  int height() const { sync(); return m_rasterizer.height(); }
+  // straight RGBA of the last rendered frame
+  std::vector<unsigned char> capture() const;
+  void writePNG(const char *filename) const;
+
+private:
+  void rasterize(const ImDrawData *, float scale, bool clear);
+  void sync() const; // waits for the frame being rasterized
+
+  const TextureManager *m_textureManager;
+  ImVec2 m_pos, m_size;
+  bool m_focus;
+  std::shared_ptr<RenderThread> m_renderThread;
+  RenderThread::Ticket m_frame;
+  DrawDataSnapshot m_snapshot;
+  DrawBatch m_drawBatch;
+  RasterizerTextures m_textures;
+  Rasterizer m_rasterizer;
+};
+
+#endif
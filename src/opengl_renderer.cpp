@@ -28,12 +28,29 @@
 constexpr int GL_TEXTURE_WRAP_S { 0x2802 },
               GL_TEXTURE_WRAP_T { 0x2803 },
               GL_REPEAT         { 0x2901 };
+#  ifndef GL_UNPACK_ROW_LENGTH
+#    define GL_UNPACK_ROW_LENGTH 0x0CF2
+#  endif
+#  ifndef GL_PIXEL_UNPACK_BUFFER
+#    define GL_PIXEL_UNPACK_BUFFER 0x88EC
+#  endif
+#  ifndef glTexSubImage2D // not used by imgui_impl_opengl3, exported by opengl32
+extern "C" __declspec(dllimport) void APIENTRY glTexSubImage2D(GLenum target,
+  GLint level, GLint xoffset, GLint yoffset, GLsizei width, GLsizei height,
+  GLenum format, GLenum type, const void *pixels);
+#  endif
 #else
 #  include <epoxy/gl.h>
 #endif
 
+#include <algorithm>
 #include <imgui/imgui.h>
 
+// timer queries are not provided by the loader used on Windows
+#ifndef _WIN32
+#  define HAVE_TIMER_QUERY
+#endif
+
 REGISTER_RENDERER(90, opengl3, "OpenGL 3.2", OpenGLRenderer::creator);
 
 constexpr const char *VERTEX_SHADER { R"(
@@ -72,13 +89,20 @@ void main()
 }
 )" };
 
+// textures up to this size are uploaded immediately
+constexpr size_t SYNC_UPLOAD_SIZE { 256 * 256 * 4 };
+// bytes of larger textures to stream per frame, shared by all windows
+constexpr size_t UPLOAD_BUDGET { 4 << 20 };
+// transparent contents of textures until their first upload completes
+constexpr unsigned int PLACEHOLDER_PIXEL {};
+
 // these must match with the sizes of the corresponding member arrays
 enum Buffers   { VertexBuf, IndexBuf };
 enum Textures  { FontTex };
 enum Locations { ProjMtxUniLoc, TexUniLoc,
                  VtxColorAttrLoc, VtxPosAttrLoc, VtxUVAttrLoc };
 
-void OpenGLRenderer::Shared::setup()
+void OpenGLRenderer::ShareGroup::setup()
 {
   unsigned int vertShader { glCreateShader(GL_VERTEX_SHADER) };
   glShaderSource(vertShader, 1, &VERTEX_SHADER, nullptr);
@@ -106,49 +130,258 @@ void OpenGLRenderer::Shared::setup()
 
   glActiveTexture(GL_TEXTURE0);
   glUniform1i(m_locations[TexUniLoc], 0);
+
+  glGenBuffers(m_pixelBuffers.size(), m_pixelBuffers.data());
+  m_nextPixelBuffer = m_uploadBudget = 0;
+  m_uploadTick = Resource::tickCount() - 1;
+  m_uploadGeneration = 0;
 }
 
-void OpenGLRenderer::Shared::teardown()
+void OpenGLRenderer::ShareGroup::teardown()
 {
   glDeleteProgram(m_program);
-  glDeleteTextures(m_textures.size(), m_textures.data());
+  for(const Upload &upload : m_uploads)
+    glDeleteTextures(1, &upload.staging);
+  m_uploads.clear();
+  glDeleteBuffers(m_pixelBuffers.size(), m_pixelBuffers.data());
+}
+
+static void setTextureParameters()
+{
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+}
+
+OpenGLRenderer::GLTexture::GLTexture(const TextureShareId shareId)
+  : shareId { shareId }
+{
+  // transparent placeholder until uploaded
+  glGenTextures(1, &name);
+  glBindTexture(GL_TEXTURE_2D, name);
+  setTextureParameters();
+  glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, 1, 1, 0,
+    GL_RGBA, GL_UNSIGNED_BYTE, &PLACEHOLDER_PIXEL);
+}
+
+OpenGLRenderer::GLTexture::~GLTexture()
+{
+  glDeleteTextures(1, &name);
+}
+
+bool OpenGLRenderer::ShareGroup::upload(const Texture &tex,
+  const std::shared_ptr<GLTexture> &texture)
+{
+  const auto upload { std::find_if(m_uploads.begin(), m_uploads.end(),
+    [&texture](const Upload &upload) { return upload.texture.lock() == texture; }) };
+
+  int width, height;
+  const unsigned char *pixels { tex.getPixels(&width, &height) };
+  if(static_cast<size_t>(width) * height * 4 > SYNC_UPLOAD_SIZE) {
+    // restarting now would never complete if updated every frame
+    if(upload != m_uploads.end()) {
+      upload->restart = upload->row > 0;
+      return false;
+    }
+    m_uploads.push_back({ texture, tex, 0, 0, 0, 0, false });
+    return true;
+  }
+
+  if(upload != m_uploads.end()) {
+    glDeleteTextures(1, &upload->staging);
+    m_uploads.erase(upload);
+  }
+
+  glBindTexture(GL_TEXTURE_2D, texture->name);
+  glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0,
+    GL_RGBA, GL_UNSIGNED_BYTE, pixels);
+  return true;
+}
+
+void OpenGLRenderer::ShareGroup::streamUploads()
+{
+  if(const unsigned int tick { Resource::tickCount() }; tick != m_uploadTick) {
+    m_uploadTick   = tick;
+    m_uploadBudget = UPLOAD_BUDGET;
+  }
+
+  while(!m_uploads.empty() && m_uploadBudget) {
+    Upload &upload { m_uploads.front() };
+    const std::shared_ptr<GLTexture> texture { upload.texture.lock() };
+    if(!texture || !upload.source.isValid()) {
+      glDeleteTextures(1, &upload.staging);
+      m_uploads.pop_front();
+      continue;
+    }
+
+    int width, height;
+    const unsigned char *pixels { upload.source.getPixels(&width, &height) };
+
+    if(!upload.row || width != upload.width || height != upload.height) {
+      upload.row = 0;
+      if(!upload.staging)
+        glGenTextures(1, &upload.staging);
+      upload.width = width, upload.height = height;
+      glBindTexture(GL_TEXTURE_2D, upload.staging);
+      setTextureParameters();
+      glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0,
+        GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    }
+    else
+      glBindTexture(GL_TEXTURE_2D, upload.staging);
+
+    const size_t stride { static_cast<size_t>(width) * 4 };
+    const int rows { std::clamp(static_cast<int>(m_uploadBudget / stride),
+                                1, height - upload.row) };
+    const size_t size { stride * rows };
+    m_uploadBudget -= std::min(size, m_uploadBudget);
+
+    // the driver copies the data to the texture asynchronously
+    const unsigned int buffer
+      { m_pixelBuffers[m_nextPixelBuffer++ % m_pixelBuffers.size()] };
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, buffer);
+    glBufferData(GL_PIXEL_UNPACK_BUFFER, size, nullptr, GL_STREAM_DRAW);
+    glBufferSubData(GL_PIXEL_UNPACK_BUFFER, 0, size, pixels + (upload.row * stride));
+    glTexSubImage2D(GL_TEXTURE_2D, 0, 0, upload.row, width, rows,
+      GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+    if((upload.row += rows) < height)
+      continue;
+
+    // replace the previous contents (or the placeholder) in every context
+    glDeleteTextures(1, &texture->name);
+    texture->name = upload.staging;
+    ++m_uploadGeneration;
+
+    Upload next { upload };
+    m_uploads.pop_front();
+    if(next.restart) { // include the changes made to the rows already streamed
+      next.staging = next.row = 0;
+      next.restart = false;
+      m_uploads.push_back(next);
+    }
+  }
+}
+
+bool OpenGLRenderer::ShareGroup::upload(const Texture &tex,
+  const std::shared_ptr<GLTexture> &texture, const TextureCmd::Region &region)
+{
+  int width, height;
+  const unsigned char *pixels { tex.getPixels(&width, &height) };
+  TextureCmd::Region target { region };
+
+  const auto upload { std::find_if(m_uploads.begin(), m_uploads.end(),
+    [&texture](const Upload &upload) { return upload.texture.lock() == texture; }) };
+  if(upload != m_uploads.end()) {
+    // rows not streamed yet will be read with the changes, the others are
+    // updated in the staging texture instead of restarting the upload
+    if(!upload->row || upload->width != width || upload->height != height)
+      return false;
+    target.bottom = std::min(target.bottom, upload->row);
+    if(target.top >= target.bottom)
+      return false;
+    glBindTexture(GL_TEXTURE_2D, upload->staging);
+  }
+  else
+    glBindTexture(GL_TEXTURE_2D, texture->name);
+
+  pixels += ((target.top * width) + target.left) * 4;
+  glPixelStorei(GL_UNPACK_ROW_LENGTH, width);
+  glTexSubImage2D(GL_TEXTURE_2D, 0, target.left, target.top,
+    target.right - target.left, target.bottom - target.top,
+    GL_RGBA, GL_UNSIGNED_BYTE, pixels);
+  glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+  return true;
+}
+
+void OpenGLRenderer::Shared::setup()
+{
+  if(m_group.use_count() == 1)
+    m_group->setup();
+}
+
+void OpenGLRenderer::Shared::teardown()
+{
+  for(const auto &texture : m_textures)
+    forget(texture);
+  m_textures.clear();
+
+  if(m_group.use_count() == 1)
+    m_group->teardown();
 }
 
 void OpenGLRenderer::Shared::textureCommand(const TextureCmd &cmd)
 {
+  unsigned int uploads {};
+
   switch(cmd.type) {
   case TextureCmd::Insert:
-    m_textures.insert(m_textures.begin() + cmd.offset, cmd.size, 0);
-    glGenTextures(cmd.size, m_textures.data() + cmd.offset);
-    [[fallthrough]];
-  case TextureCmd::Update:
+    m_textures.insert(m_textures.begin() + cmd.offset, cmd.size, nullptr);
     for(size_t i {}; i < cmd.size; ++i) {
-      int width, height;
-      const unsigned char *pixels { cmd[i].getPixels(&width, &height) };
-      glBindTexture(GL_TEXTURE_2D, m_textures[cmd.offset + i]);
-      glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-      glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-      glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-      glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-      glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, pixels);
+      const Texture &tex { cmd[i] };
+      std::shared_ptr<GLTexture> &texture { m_textures[cmd.offset + i] };
+
+      // reuse the texture uploaded by another context
+      std::weak_ptr<GLTexture> *shared {};
+      if(tex.shareId()) {
+        shared = &m_group->m_textures[tex.shareId()];
+        if((texture = shared->lock()))
+          continue;
+      }
+
+      texture = std::make_shared<GLTexture>(tex.shareId());
+      if(shared)
+        *shared = texture;
+      uploads += m_group->upload(tex, texture);
     }
     break;
-  case TextureCmd::Remove:
-    glDeleteTextures(cmd.size, m_textures.data() + cmd.offset);
-    m_textures.erase(m_textures.begin() + cmd.offset,
-                     m_textures.begin() + cmd.offset + cmd.size);
+  case TextureCmd::Update:
+    for(size_t i {}; i < cmd.size; ++i)
+      uploads += m_group->upload(cmd[i], m_textures[cmd.offset + i]);
+    break;
+  case TextureCmd::UpdateRegion:
+    for(size_t i {}; i < cmd.size; ++i)
+      uploads += m_group->upload(cmd[i], m_textures[cmd.offset + i], cmd.region);
+    break;
+  case TextureCmd::Remove: {
+    const auto begin { m_textures.begin() + cmd.offset },
+               end   { begin + cmd.size };
+    for(auto it { begin }; it != end; ++it)
+      forget(*it);
+    m_textures.erase(begin, end);
     break;
   }
+  }
+
+  cmd.manager->addUploads(uploads);
+}
+
+void OpenGLRenderer::Shared::forget(const std::shared_ptr<GLTexture> &texture)
+{
+  // the texture is about to be deleted if no other context is using it
+  if(texture->shareId && texture.use_count() == 1)
+    m_group->m_textures.erase(texture->shareId);
 }
 
 OpenGLRenderer::OpenGLRenderer
   (RendererFactory *factory, Window *window, const bool share)
-  : Renderer { window }
+  : Renderer { window }, m_timerQueries {}, m_nextTimerQuery { 0 },
+    m_hasTimerQueries { false }
 {
   m_shared = factory->getSharedData<Shared>();
   if(!m_shared || !share) {
     m_shared = std::make_shared<Shared>();
     factory->setSharedData(m_shared);
+
+    if(share)
+      m_shared->m_group = factory->getGlobalData<ShareGroup>();
+    if(!m_shared->m_group) {
+      m_shared->m_group = std::make_shared<ShareGroup>();
+      if(share)
+        factory->setGlobalData(m_shared->m_group);
+    }
   }
 }
 
@@ -157,7 +390,8 @@ void OpenGLRenderer::setup()
   if(m_shared.use_count() == 1)
     m_shared->setup();
 
-  glUseProgram(m_shared->m_program);
+  const ShareGroup &group { *m_shared->m_group };
+  glUseProgram(group.m_program);
 
   glGenVertexArrays(1, &m_vbo);
   glBindVertexArray(m_vbo);
@@ -165,22 +399,35 @@ void OpenGLRenderer::setup()
   glGenBuffers(m_buffers.size(), m_buffers.data());
   glBindBuffer(GL_ARRAY_BUFFER, m_buffers[VertexBuf]);
   glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_buffers[IndexBuf]);
-  glEnableVertexAttribArray(m_shared->m_locations[VtxPosAttrLoc]);
-  glVertexAttribPointer(m_shared->m_locations[VtxPosAttrLoc],
+  glEnableVertexAttribArray(group.m_locations[VtxPosAttrLoc]);
+  glVertexAttribPointer(group.m_locations[VtxPosAttrLoc],
     2, GL_FLOAT, GL_FALSE, sizeof(ImDrawVert),
     reinterpret_cast<void *>(IM_OFFSETOF(ImDrawVert, pos)));
-  glEnableVertexAttribArray(m_shared->m_locations[VtxUVAttrLoc]);
-  glVertexAttribPointer(m_shared->m_locations[VtxUVAttrLoc],
+  glEnableVertexAttribArray(group.m_locations[VtxUVAttrLoc]);
+  glVertexAttribPointer(group.m_locations[VtxUVAttrLoc],
     2, GL_FLOAT, GL_FALSE, sizeof(ImDrawVert),
     reinterpret_cast<void *>(IM_OFFSETOF(ImDrawVert, uv)));
-  glEnableVertexAttribArray(m_shared->m_locations[VtxColorAttrLoc]);
-  glVertexAttribPointer(m_shared->m_locations[VtxColorAttrLoc],
+  glEnableVertexAttribArray(group.m_locations[VtxColorAttrLoc]);
+  glVertexAttribPointer(group.m_locations[VtxColorAttrLoc],
     4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(ImDrawVert),
     reinterpret_cast<void *>(IM_OFFSETOF(ImDrawVert, col)));
 
   glEnable(GL_BLEND);
   glBlendEquation(GL_FUNC_ADD);
   glBlendFuncSeparate(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA, GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+
+#ifdef HAVE_TIMER_QUERY
+#  ifdef __APPLE__
+  m_hasTimerQueries = true; // GL_ARB_timer_query is always supported
+#  else
+  m_hasTimerQueries = epoxy_gl_version() >= 33 ||
+    epoxy_has_gl_extension("GL_ARB_timer_query");
+#  endif
+  if(m_hasTimerQueries) {
+    for(TimerQuery &query : m_timerQueries)
+      glGenQueries(1, &query.name);
+  }
+#endif
 }
 
 void OpenGLRenderer::teardown()
@@ -190,6 +437,13 @@ void OpenGLRenderer::teardown()
 
   glDeleteBuffers(m_buffers.size(), m_buffers.data());
   glDeleteVertexArrays(1, &m_vbo);
+
+#ifdef HAVE_TIMER_QUERY
+  if(m_hasTimerQueries) {
+    for(const TimerQuery &query : m_timerQueries)
+      glDeleteQueries(1, &query.name);
+  }
+#endif
 }
 
 void OpenGLRenderer::updateTextures()
@@ -197,22 +451,56 @@ void OpenGLRenderer::updateTextures()
   using namespace std::placeholders;
   m_window->context()->textureManager()->update(&m_shared->m_cookie,
     std::bind(&Shared::textureCommand, m_shared.get(), _1));
+  m_shared->m_group->streamUploads();
+}
+
+bool OpenGLRenderer::hasTextureUpdates() const
+{
+  const TextureManager *manager { m_window->context()->textureManager() };
+  return !manager->isSynced(m_shared->m_cookie) ||
+    !m_shared->m_group->m_uploads.empty();
 }
 
 void OpenGLRenderer::render(const bool flip)
 {
   const ImGuiViewport *viewport { m_window->viewport() };
   const ImDrawData *drawData { viewport->DrawData };
+  const float scale { viewport->DpiScale };
+  const DrawBatch &batch { batchDrawCalls(drawData, ImVec2(scale, scale)) };
+
+#ifdef HAVE_TIMER_QUERY
+  TimerQuery *timerQuery {};
+  if(m_hasTimerQueries) {
+    readTimerQueries();
+    // the result of the oldest query is dropped if still not available
+    timerQuery = &m_timerQueries[m_nextTimerQuery];
+    m_nextTimerQuery = (m_nextTimerQuery + 1) % m_timerQueries.size();
+    timerQuery->pending = true;
+    glBeginQuery(GL_TIME_ELAPSED, timerQuery->name);
+  }
+#endif
+
+  draw(drawData, batch, scale,
+    !(viewport->Flags & ImGuiViewportFlags_NoRendererClear), flip);
+
+#ifdef HAVE_TIMER_QUERY
+  if(timerQuery)
+    glEndQuery(GL_TIME_ELAPSED);
+#endif
+}
 
-  if(!(viewport->Flags & ImGuiViewportFlags_NoRendererClear)) {
+void OpenGLRenderer::draw(const ImDrawData *drawData, const DrawBatch &batch,
+  const float scale, const bool clear, const bool flip)
+{
+  if(clear) {
     glClearColor(0.f, 0.f, 0.f, 0.f); // premultiplied alpha
     glClear(GL_COLOR_BUFFER_BIT);
   }
 
   glEnable(GL_SCISSOR_TEST);
 
-  const float height { drawData->DisplaySize.y * viewport->DpiScale };
-  glViewport(0, 0, drawData->DisplaySize.x * viewport->DpiScale, height);
+  const float height { drawData->DisplaySize.y * scale };
+  glViewport(0, 0, drawData->DisplaySize.x * scale, height);
 
   // re-bind non-shared objets (we're reusing the same GL context on Windows)
   glBindVertexArray(m_vbo);
@@ -221,40 +509,86 @@ void OpenGLRenderer::render(const bool flip)
 
   // update shader variables
   const ProjMtx projMtx { drawData->DisplayPos, drawData->DisplaySize, flip };
-  glUniformMatrix4fv(m_shared->m_locations[ProjMtxUniLoc], 1, GL_FALSE, &projMtx);
+  glUniformMatrix4fv(m_shared->m_group->m_locations[ProjMtxUniLoc], 1, GL_FALSE, &projMtx);
 
-  const ImVec2 &clipOffset { drawData->DisplayPos },
-               &clipScale  { viewport->DpiScale, viewport->DpiScale };
-  for(int i { 0 }; i < drawData->CmdListsCount; ++i) {
-    const ImDrawList *cmdList { drawData->CmdLists[i] };
-
-    glBufferData(GL_ARRAY_BUFFER,
-      static_cast<GLsizeiptr>(cmdList->VtxBuffer.Size * sizeof(ImDrawVert)),
-      static_cast<const void *>(cmdList->VtxBuffer.Data), GL_STREAM_DRAW);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER,
-      static_cast<GLsizeiptr>(cmdList->IdxBuffer.Size * sizeof(ImDrawIdx)),
-      static_cast<const void *>(cmdList->IdxBuffer.Data), GL_STREAM_DRAW);
-
-    for(int j { 0 }; j < cmdList->CmdBuffer.Size; ++j) {
-      const ImDrawCmd *cmd { &cmdList->CmdBuffer[j] };
-      if(cmd->UserCallback)
-        continue; // no need to call the callback, not using them
-
-      const ClipRect clipRect { cmd->ClipRect, clipOffset, clipScale };
-      if(!clipRect)
-        continue;
+  // upload the vertices and indices of all draw lists at once
+  const size_t vtxOffset { uploadBuffer(GL_ARRAY_BUFFER,
+    m_streams[VertexBuf], drawData, &ImDrawList::VtxBuffer) };
+  const size_t idxOffset { uploadBuffer(GL_ELEMENT_ARRAY_BUFFER,
+    m_streams[IndexBuf], drawData, &ImDrawList::IdxBuffer) };
+
+  for(const DrawBatch::Call &call : batch) {
+    const ClipRect &clipRect { call.clipRect };
+    if(call.setClipRect) {
       glScissor(clipRect.left, flip ? clipRect.top : height - clipRect.bottom,
         clipRect.right - clipRect.left, clipRect.bottom - clipRect.top);
-
-      // Bind texture, Draw
-      glBindTexture(GL_TEXTURE_2D, m_shared->m_textures[cmd->GetTexID()]);
-      glDrawElementsBaseVertex(GL_TRIANGLES, cmd->ElemCount,
-        sizeof(ImDrawIdx) == 2 ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT,
-        (void*)(intptr_t)(cmd->IdxOffset * sizeof(ImDrawIdx)),
-        cmd->VtxOffset);
     }
+    if(call.setTexture)
+      glBindTexture(GL_TEXTURE_2D, m_shared->m_textures[call.texture]->name);
+
+    glDrawElementsBaseVertex(GL_TRIANGLES, call.elemCount,
+      sizeof(ImDrawIdx) == 2 ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT,
+      (void*)(intptr_t)((idxOffset + call.idxOffset) * sizeof(ImDrawIdx)),
+      vtxOffset + call.vtxOffset);
   }
 
   // allow glClear to modify the whole framebuffer
   glDisable(GL_SCISSOR_TEST);
 }
+
+void OpenGLRenderer::readTimerQueries()
+{
+#ifdef HAVE_TIMER_QUERY
+  // oldest first, results become available in order
+  for(size_t i {}; i < m_timerQueries.size(); ++i) {
+    TimerQuery &query
+      { m_timerQueries[(m_nextTimerQuery + i) % m_timerQueries.size()] };
+    if(!query.pending)
+      continue;
+
+    GLint available;
+    glGetQueryObjectiv(query.name, GL_QUERY_RESULT_AVAILABLE, &available);
+    if(!available)
+      break;
+
+    GLuint64 nanoseconds;
+    glGetQueryObjectui64v(query.name, GL_QUERY_RESULT, &nanoseconds);
+    m_timings[ReaImGuiFrameStage_GPU].add(nanoseconds / 1e9);
+    query.pending = false;
+  }
+#endif
+}
+
+bool OpenGLRenderer::isDirty() const
+{
+  // keep rendering until streamed textures are fully uploaded
+  return !m_shared->m_group->m_uploads.empty();
+}
+
+unsigned int OpenGLRenderer::uploadGeneration() const
+{
+  // another viewport may complete the upload of a texture drawn by this one
+  return m_shared->m_group->m_uploadGeneration;
+}
+
+template<typename T>
+size_t OpenGLRenderer::uploadBuffer(const unsigned int target,
+  StreamBuffer &stream, const ImDrawData *drawData,
+  ImVector<T> ImDrawList::*buffer)
+{
+  m_staging.clear();
+  for(int i { 0 }; i < drawData->CmdListsCount; ++i) {
+    const ImVector<T> &data { drawData->CmdLists[i]->*buffer };
+    const char *bytes { reinterpret_cast<const char *>(data.Data) };
+    m_staging.insert(m_staging.end(), bytes, bytes + data.size_in_bytes());
+  }
+
+  const size_t size { m_staging.size() / sizeof(T) };
+  const StreamBuffer::Range range { stream.allocate(size) };
+  if(range.orphan)
+    glBufferData(target, stream.capacity() * sizeof(T), nullptr, GL_STREAM_DRAW);
+  glBufferSubData(target, range.offset * sizeof(T),
+    m_staging.size(), m_staging.data());
+
+  return range.offset;
+}
@@ -22,6 +22,12 @@
 #include "texture.hpp"
 
 #include <array>
+#include <deque>
+#include <unordered_map>
+
+struct ImDrawData;
+struct ImDrawList;
+template<typename T> struct ImVector;
 
 class OpenGLRenderer : public Renderer {
 public:
@@ -33,28 +39,90 @@ public:
 
 protected:
   void updateTextures();
+  // whether updateTextures() has pixels to read and upload
+  bool hasTextureUpdates() const;
   void render(bool flip);
+  // only uses the given frame and the GL objects, may run on the render thread
+  void draw(const ImDrawData *, const DrawBatch &, float scale,
+            bool clear, bool flip);
+  bool isDirty() const override;
+  unsigned int uploadGeneration() const override;
+
+  struct GLTexture {
+    GLTexture(TextureShareId);
+    GLTexture(const GLTexture &) = delete;
+    ~GLTexture();
+
+    unsigned int name;
+    const TextureShareId shareId;
+  };
+
+  // objects shared by the windows of every context (one GL share group)
+  struct ShareGroup {
+    // large textures are streamed over multiple frames through a pixel buffer
+    struct Upload {
+      std::weak_ptr<GLTexture> texture; // displayed until the upload completes
+      Texture source;
+      unsigned int staging;
+      int width, height, row;
+      bool restart; // modified after streaming started, upload again once done
+    };
 
-  struct Shared {
     void setup();
     void teardown();
-    void textureCommand(const TextureCmd &);
+    // return whether a new upload was started
+    bool upload(const Texture &, const std::shared_ptr<GLTexture> &);
+    bool upload(const Texture &, const std::shared_ptr<GLTexture> &,
+                const TextureCmd::Region &);
+    void streamUploads();
 
     unsigned int m_program;
-    TextureCookie m_cookie;
-    std::vector<unsigned int> m_textures;
     std::array<unsigned int, 5> m_locations;
+    std::array<unsigned int, 3> m_pixelBuffers;
+    std::unordered_map<TextureShareId, std::weak_ptr<GLTexture>> m_textures;
+    std::deque<Upload> m_uploads;
+    size_t m_nextPixelBuffer, m_uploadBudget;
+    unsigned int m_uploadTick; // the budget is shared by all contexts
+    unsigned int m_uploadGeneration; // incremented when an upload completes
     std::shared_ptr<void> m_platform;
   };
 
+  // objects shared by the windows of a context
+  struct Shared {
+    void setup();
+    void teardown();
+    void textureCommand(const TextureCmd &);
+    void forget(const std::shared_ptr<GLTexture> &);
+
+    std::shared_ptr<ShareGroup> m_group;
+    TextureCookie m_cookie;
+    std::vector<std::shared_ptr<GLTexture>> m_textures;
+  };
+
   void setup();
   void teardown();
 
   std::shared_ptr<Shared> m_shared;
 
 private:
+  // GPU time of previous frames, read without waiting for the results
+  struct TimerQuery {
+    unsigned int name;
+    bool pending;
+  };
+
+  template<typename T>
+  size_t uploadBuffer(unsigned int target, StreamBuffer &,
+    const ImDrawData *, ImVector<T> ImDrawList::*);
+  void readTimerQueries();
+
   unsigned int m_vbo;
   std::array<unsigned int, 2> m_buffers;
+  std::array<StreamBuffer, 2> m_streams;
+  std::vector<char> m_staging;
+  std::array<TimerQuery, 3> m_timerQueries;
+  size_t m_nextTimerQuery;
+  bool m_hasTimerQueries;
 };
 
 #endif
@@ -20,15 +20,10 @@
 #include "error.hpp"
 
 #include <png.h>   // http://www.libpng.org/pub/png/libpng-manual.txt
-#include <cstring> // strerror
+#include <cstring> // memcpy, strerror
 
 constexpr size_t HEADER_SIZE { 8 }; // must not be > 8
 
-class PNGImage final : public Bitmap {
-public:
-  PNGImage(std::istream &);
-};
-
 static bool isPNG(std::istream &stream)
 {
   png_byte header[HEADER_SIZE];
@@ -37,12 +32,16 @@ static bool isPNG(std::istream &stream)
   return png_check_sig(header, sizeof(header));
 }
 
-static Image *create(std::istream &stream)
-{
-  return new PNGImage(stream);
-}
+static void decode(std::istream &, BitmapData *, const BitmapData::MaxSize &);
+static void decodeMemory(const unsigned char *, size_t, BitmapData *,
+  const BitmapData::MaxSize &);
 
-static const Image::RegisterType PNG { &isPNG, &create };
+static const Image::RegisterType PNG { &isPNG, &decode, &decodeMemory };
+
+struct MemoryReader {
+  const unsigned char *data;
+  size_t size, offset;
+};
 
 static void read(png_structp png, png_bytep data, const png_size_t length)
 {
@@ -51,6 +50,28 @@ static void read(png_structp png, png_bytep data, const png_size_t length)
     png_error(png, stream.eof() ? "premature end of file" : strerror(errno));
 }
 
+static void readMemory(png_structp png, png_bytep data, const png_size_t length)
+{
+  MemoryReader &reader { *static_cast<MemoryReader *>(png_get_io_ptr(png)) };
+  if(length > reader.size - reader.offset)
+    png_error(png, "premature end of file");
+  memcpy(data, reader.data + reader.offset, length);
+  reader.offset += length;
+}
+
+static void write(png_structp png, png_bytep data, const png_size_t length)
+{
+  std::ostream &stream { *static_cast<std::ostream *>(png_get_io_ptr(png)) };
+  if(!stream.write(reinterpret_cast<const char *>(data), length))
+    png_error(png, strerror(errno));
+}
+
+static void flush(png_structp png)
+{
+  std::ostream &stream { *static_cast<std::ostream *>(png_get_io_ptr(png)) };
+  stream.flush();
+}
+
 static void error(png_structp, const char *what)
 {
   throw reascript_error { what };
@@ -85,7 +106,8 @@ static void transformToRGBA(png_structp png, png_infop info)
   png_read_update_info(png, info);
 }
 
-PNGImage::PNGImage(std::istream &stream)
+static void decode(BitmapData *bitmap, void *io, const png_rw_ptr readFn,
+  const BitmapData::MaxSize &maxSize)
 {
   struct PNG {
     ~PNG() { png_destroy_read_struct(&read, &info, nullptr); }
@@ -101,15 +123,56 @@ PNGImage::PNGImage(std::istream &stream)
 
   // png_set_user_limits(png.read, maxWidth, maxHeight);
 
-  png_set_read_fn(png.read, &stream, read);
+  png_set_read_fn(png.read, io, readFn);
   png_set_sig_bytes(png.read, HEADER_SIZE);
   png_read_info(png.read, png.info);
   transformToRGBA(png.read, png.info);
 
-  resize(png_get_image_width(png.read,  png.info),
-         png_get_image_height(png.read, png.info),
-         png_get_rowbytes(png.read,     png.info) /
-         png_get_image_width(png.read,  png.info));
+  bitmap->resize(png_get_image_width(png.read,  png.info),
+                 png_get_image_height(png.read, png.info),
+                 png_get_rowbytes(png.read,     png.info) /
+                 png_get_image_width(png.read,  png.info), maxSize);
+
+  png_read_image(png.read, bitmap->makeScanlines().data());
+}
+
+// PNG cannot be decoded at a smaller size, it is shrunk afterward
+static void decode(std::istream &stream, BitmapData *bitmap,
+  const BitmapData::MaxSize &maxSize)
+{
+  decode(bitmap, &stream, &read, maxSize);
+}
+
+static void decodeMemory(const unsigned char *data, const size_t size,
+  BitmapData *bitmap, const BitmapData::MaxSize &maxSize)
+{
+  // the signature was already checked by isPNG
+  MemoryReader reader { data, size, HEADER_SIZE };
+  decode(bitmap, &reader, &readMemory, maxSize);
+}
+
+void writePNG(std::ostream &stream, const unsigned char *rgba,
+  const int width, const int height)
+{
+  struct PNG {
+    ~PNG() { png_destroy_write_struct(&write, &info); }
+    png_structp write;
+    png_infop   info;
+  } png;
+
+  if(!(png.write =
+      png_create_write_struct(PNG_LIBPNG_VER_STRING, nullptr, error, nullptr)))
+    throw reascript_error { "failed to create PNG write structure" };
+  if(!(png.info = png_create_info_struct(png.write)))
+    throw reascript_error { "failed to create PNG info structure" };
+
+  png_set_write_fn(png.write, &stream, write, flush);
+  png_set_IHDR(png.write, png.info, width, height, 8, PNG_COLOR_TYPE_RGBA,
+    PNG_INTERLACE_NONE, PNG_COMPRESSION_TYPE_DEFAULT, PNG_FILTER_TYPE_DEFAULT);
+  png_write_info(png.write, png.info);
+
+  for(int y {}; y < height; ++y)
+    png_write_row(png.write, rgba + (static_cast<size_t>(y) * width * 4));
 
-  png_read_image(png.read, makeScanlines().data());
+  png_write_end(png.write, nullptr);
 }
@@ -0,0 +1,35 @@
+/* ReaImGui: ReaScript binding for Dear ImGui
+ * Copyright (C) 2021-2024  Christian Fillion
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef REAIMGUI_RENDER_THREAD_HPP
+#define REAIMGUI_RENDER_THREAD_HPP
+
+#include "job_queue.hpp"
+
+#include <memory>
+
+// Executes rendering jobs in submission order on a background thread
+class RenderThread : public JobQueue {
+public:
+  // stopped after the pending jobs once the last user releases it
+  static std::shared_ptr<RenderThread> get();
+
+  RenderThread() : JobQueue { 1 } {}
+};
+
+#endif
@@ -17,11 +17,17 @@
 
 #include "renderer.hpp"
 
+#include "context.hpp"
 #include "settings.hpp"
+#include "texture.hpp"
 #include "viewport_forwarder.hpp"
 #include "window.hpp"
 
+#include <algorithm>
 #include <cassert>
+#include <cfloat>
+#include <cmath>
+#include <cstring>
 #include <imgui/imgui.h>
 
 static auto &typeHead()
@@ -61,7 +67,7 @@ RendererType::Register::Register(RendererType *type)
 }
 
 RendererFactory::RendererFactory()
-  : m_type { Settings::Renderer }
+  : m_type { Settings::Renderer }, m_frameStats {}, m_lastFrameStats {}
 {
   assert(m_type);
 }
@@ -71,6 +77,41 @@ std::unique_ptr<Renderer> RendererFactory::create(Window *window)
   return m_type->creator(this, window);
 }
 
+void RendererFactory::addDrawStats(const DrawBatch::Stats &stats)
+{
+  m_frameStats.commands  += stats.commands;
+  m_frameStats.drawCalls += stats.drawCalls;
+  m_frameStats.clipRects += stats.clipRects;
+  m_frameStats.textures  += stats.textures;
+}
+
+void RendererFactory::nextFrame()
+{
+  m_lastFrameStats = m_frameStats;
+  m_frameStats = {};
+}
+
+StreamBuffer::StreamBuffer()
+  : m_capacity {}, m_offset {}
+{
+}
+
+StreamBuffer::Range StreamBuffer::allocate(const size_t size)
+{
+  // frames per reallocation when the amount of data is stable
+  constexpr size_t RING_FRAMES { 4 };
+
+  if(m_offset + size <= m_capacity) {
+    const Range range { m_offset, false };
+    m_offset += size;
+    return range;
+  }
+
+  m_capacity = std::max(m_capacity, size * RING_FRAMES);
+  m_offset = size;
+  return { 0, true };
+}
+
 void Renderer::install()
 {
   using Forwarder = ViewportForwarder<&ImGuiViewport::RendererUserData>;
@@ -81,19 +122,68 @@ void Renderer::install()
   // pio.Renderer_CreateWindow  = &createViewport;
   // pio.Renderer_DestroyWindow = &destroyViewport;
   pio.Renderer_SetWindowSize = &Forwarder::wrap<&Renderer::setSize>;
-  pio.Renderer_RenderWindow  = &Forwarder::wrap<&Renderer::render>;
-  pio.Renderer_SwapBuffers   = &Forwarder::wrap<&Renderer::swapBuffers>;
+  pio.Renderer_RenderWindow  = &Forwarder::wrap<&Renderer::renderWindow>;
+  pio.Renderer_SwapBuffers   = &Forwarder::wrap<&Renderer::swapWindow>;
 }
 
 Renderer::Renderer(Window *window)
-  : m_window { window }
+  : m_window { window }, m_frameHash {}, m_skipFrame { false }
 {
   m_window->viewport()->RendererUserData = this;
 }
 
 Renderer::~Renderer()
 {
-  m_window->viewport()->RendererUserData = nullptr;
+  if(ImGuiViewport *viewport { m_window->viewport() }) // unless pooled
+    viewport->RendererUserData = nullptr;
+}
+
+void Renderer::rebind()
+{
+  m_window->viewport()->RendererUserData = this;
+  m_timings = {};
+  invalidate(); // the window was hidden
+}
+
+void Renderer::renderWindow(void *userData)
+{
+  const ImGuiViewport *viewport { m_window->viewport() };
+  FrameHash hash;
+  hash.addDrawData(viewport->DrawData);
+  hash.add(viewport->DpiScale);
+  hash.add(viewport->Flags);
+  hash.add(m_window->context()->textureManager()->version());
+  hash.add(uploadGeneration());
+
+  m_skipFrame = hash.value() == m_frameHash && !isDirty();
+  if(m_skipFrame)
+    return;
+
+  m_frameHash = hash.value();
+  StageTimer timer { m_timings[ReaImGuiFrameStage_Draw] };
+  render(userData);
+}
+
+void Renderer::swapWindow(void *userData)
+{
+  if(m_skipFrame)
+    return;
+
+  StageTimer timer { m_timings[ReaImGuiFrameStage_Swap] };
+  swapBuffers(userData);
+}
+
+int Renderer::swapInterval() const
+{
+  return m_window->context()->swapInterval();
+}
+
+const DrawBatch &Renderer::batchDrawCalls(const ImDrawData *drawData,
+  const ImVec2 &clipScale)
+{
+  m_drawBatch.build(drawData, clipScale);
+  m_window->context()->rendererFactory()->addDrawStats(m_drawBatch.stats());
+  return m_drawBatch;
 }
 
 Renderer::ProjMtx::ProjMtx(const ImVec2 &pos, const ImVec2 &size, const bool flip)
@@ -114,7 +204,13 @@ Renderer::ProjMtx::ProjMtx(const ImVec2 &pos, const ImVec2 &size, const bool fli
   }};
 }
 
-Renderer::ClipRect::ClipRect
+ClipRect::ClipRect(const long left, const long top,
+    const long right, const long bottom)
+  : left { left }, top { top }, right { right }, bottom { bottom }
+{
+}
+
+ClipRect::ClipRect
     (const ImVec4 &rect, const ImVec2 &offset, const ImVec2 &scale)
   : left   { static_cast<long>((rect.x - offset.x) * scale.x) },
     top    { static_cast<long>((rect.y - offset.y) * scale.y) },
@@ -123,7 +219,264 @@ Renderer::ClipRect::ClipRect
 {
 }
 
-Renderer::ClipRect::operator bool() const
+ClipRect::operator bool() const
 {
   return right > left && bottom > top;
 }
+
+void DrawBatch::build(const ImDrawData *drawData, const ImVec2 &clipScale)
+{
+  m_calls.clear();
+  m_stats = {};
+
+  unsigned int vtxBase {}, idxBase {};
+  for(int i {}; i < drawData->CmdListsCount; ++i) {
+    const ImDrawList *cmdList { drawData->CmdLists[i] };
+
+    for(const ImDrawCmd &cmd : cmdList->CmdBuffer) {
+      if(cmd.UserCallback || !cmd.ElemCount)
+        continue; // no need to call the callback, not using them
+      ++m_stats.commands;
+
+      const ClipRect clipRect { cmd.ClipRect, drawData->DisplayPos, clipScale };
+      if(!clipRect)
+        continue;
+
+      const size_t texture { cmd.GetTexID() };
+      const unsigned int vtxOffset { vtxBase + cmd.VtxOffset },
+                         idxOffset { idxBase + cmd.IdxOffset };
+      Call *prev { m_calls.empty() ? nullptr : &m_calls.back() };
+
+      // indices are relative to the vertex offset: commands from different
+      // draw lists cannot be merged, only their state changes can be skipped
+      if(prev && prev->texture == texture && prev->clipRect == clipRect &&
+          prev->vtxOffset == vtxOffset &&
+          prev->idxOffset + prev->elemCount == idxOffset) {
+        prev->elemCount += cmd.ElemCount;
+        continue;
+      }
+
+      const bool setClipRect { !prev || prev->clipRect != clipRect },
+                 setTexture  { !prev || prev->texture  != texture  };
+      m_calls.push_back({ clipRect, texture, vtxOffset, idxOffset,
+                          cmd.ElemCount, setClipRect, setTexture });
+      m_stats.clipRects += setClipRect;
+      m_stats.textures  += setTexture;
+    }
+
+    vtxBase += cmdList->VtxBuffer.Size;
+    idxBase += cmdList->IdxBuffer.Size;
+  }
+
+  m_stats.drawCalls = m_calls.size();
+}
+
+template<typename T>
+static void copyVector(ImVector<T> &dst, const ImVector<T> &src)
+{
+  // ImVector's assignment operator frees the previous storage
+  dst.resize(src.Size);
+  if(src.Size)
+    std::memcpy(dst.Data, src.Data, src.size_in_bytes());
+}
+
+DrawDataSnapshot::DrawDataSnapshot()
+  : m_drawData { std::make_unique<ImDrawData>() }
+{
+}
+
+DrawDataSnapshot::~DrawDataSnapshot() = default;
+
+void DrawDataSnapshot::copy(const ImDrawData *drawData)
+{
+  *m_drawData = *drawData; // CmdLists are replaced below
+
+  const size_t count { static_cast<size_t>(drawData->CmdListsCount) };
+  while(m_lists.size() < count)
+    m_lists.push_back(std::make_unique<ImDrawList>(nullptr));
+
+  for(size_t i {}; i < count; ++i) {
+    const ImDrawList *source { drawData->CmdLists[i] };
+    ImDrawList *list { m_lists[i].get() };
+    copyVector(list->CmdBuffer, source->CmdBuffer);
+    copyVector(list->IdxBuffer, source->IdxBuffer);
+    copyVector(list->VtxBuffer, source->VtxBuffer);
+    m_drawData->CmdLists[i] = list;
+  }
+}
+
+// FNV-1a over 64-bit words
+constexpr uint64_t FNV_OFFSET { 0xcbf29ce484222325 }, FNV_PRIME { 0x100000001b3 };
+
+FrameHash::FrameHash()
+  : m_value { FNV_OFFSET }
+{
+}
+
+void FrameHash::add(const void *data, size_t size)
+{
+  const char *bytes { static_cast<const char *>(data) };
+
+  for(; size >= sizeof(uint64_t); size -= sizeof(uint64_t)) {
+    uint64_t word;
+    std::memcpy(&word, bytes, sizeof(word));
+    m_value = (m_value ^ word) * FNV_PRIME;
+    bytes += sizeof(word);
+  }
+
+  while(size--)
+    m_value = (m_value ^ static_cast<unsigned char>(*bytes++)) * FNV_PRIME;
+}
+
+void FrameHash::addDrawData(const ImDrawData *drawData)
+{
+  add(drawData->DisplayPos);
+  add(drawData->DisplaySize);
+  add(drawData->CmdListsCount);
+
+  for(int i {}; i < drawData->CmdListsCount; ++i) {
+    const ImDrawList *cmdList { drawData->CmdLists[i] };
+    add(cmdList->VtxBuffer.Data, cmdList->VtxBuffer.size_in_bytes());
+    add(cmdList->IdxBuffer.Data, cmdList->IdxBuffer.size_in_bytes());
+    add(cmdList->CmdBuffer.Size);
+
+    // hashing each field as ImDrawCmd contains padding
+    for(const ImDrawCmd &cmd : cmdList->CmdBuffer) {
+      add(cmd.ClipRect);
+      add(cmd.TextureId);
+      add(cmd.VtxOffset);
+      add(cmd.IdxOffset);
+      add(cmd.ElemCount);
+    }
+  }
+}
+
+static ClipRect intersect(const ClipRect &a, const ClipRect &b)
+{
+  return { std::max(a.left,  b.left),  std::max(a.top,    b.top),
+           std::min(a.right, b.right), std::min(a.bottom, b.bottom) };
+}
+
+static ClipRect unite(const ClipRect &a, const ClipRect &b)
+{
+  return { std::min(a.left,  b.left),  std::min(a.top,    b.top),
+           std::max(a.right, b.right), std::max(a.bottom, b.bottom) };
+}
+
+static long long area(const ClipRect &rect)
+{
+  return static_cast<long long>(rect.right - rect.left) * (rect.bottom - rect.top);
+}
+
+DamageTracker::DamageTracker()
+  : m_viewport { 0, 0, 0, 0 }, m_invalid { true }
+{
+}
+
+void DamageTracker::update(const ImDrawData *drawData, const ImVec2 &scale)
+{
+  const ClipRect viewport { ImVec4(0.f, 0.f,
+    drawData->DisplaySize.x, drawData->DisplaySize.y), ImVec2(), scale };
+
+  m_regions.clear();
+  m_prevTriangles.swap(m_triangles);
+  m_triangles.clear();
+
+  for(int i {}; i < drawData->CmdListsCount; ++i) {
+    const ImDrawList *cmdList { drawData->CmdLists[i] };
+
+    for(const ImDrawCmd &cmd : cmdList->CmdBuffer) {
+      if(cmd.UserCallback)
+        continue;
+      const ClipRect clipRect { intersect(viewport,
+        ClipRect { cmd.ClipRect, drawData->DisplayPos, scale }) };
+      if(!clipRect)
+        continue;
+
+      const ImDrawVert *vertices { &cmdList->VtxBuffer[cmd.VtxOffset] };
+      const ImDrawIdx  *indices  { &cmdList->IdxBuffer[cmd.IdxOffset] };
+      for(unsigned int j {}; j + 3 <= cmd.ElemCount; j += 3) {
+        FrameHash hash;
+        hash.add(cmd.TextureId);
+        hash.add(clipRect);
+        ImVec2 min { FLT_MAX, FLT_MAX }, max { -FLT_MAX, -FLT_MAX };
+        for(unsigned int k {}; k < 3; ++k) {
+          const ImDrawVert &vertex { vertices[indices[j + k]] };
+          hash.add(vertex.pos);
+          hash.add(vertex.uv);
+          hash.add(vertex.col);
+          min.x = std::min(min.x, vertex.pos.x);
+          min.y = std::min(min.y, vertex.pos.y);
+          max.x = std::max(max.x, vertex.pos.x);
+          max.y = std::max(max.y, vertex.pos.y);
+        }
+
+        const ImVec2 &offset { drawData->DisplayPos };
+        const ClipRect bounds { intersect(clipRect, {
+          static_cast<long>(std::floor((min.x - offset.x) * scale.x)),
+          static_cast<long>(std::floor((min.y - offset.y) * scale.y)),
+          static_cast<long>(std::ceil ((max.x - offset.x) * scale.x)),
+          static_cast<long>(std::ceil ((max.y - offset.y) * scale.y)),
+        }) };
+        if(bounds)
+          m_triangles.push_back({ hash.value(), bounds });
+      }
+    }
+  }
+
+  if(m_invalid || viewport != m_viewport) {
+    m_invalid  = false;
+    m_viewport = viewport;
+    if(viewport)
+      m_regions.push_back(viewport);
+    return;
+  }
+
+  // skip the triangles that are identical at the start and end of both frames
+  const std::vector<Triangle> &prev { m_prevTriangles }, &next { m_triangles };
+  size_t prefix {}, suffix {};
+  const size_t common { std::min(prev.size(), next.size()) };
+  while(prefix < common && prev[prefix] == next[prefix])
+    ++prefix;
+  while(suffix < common - prefix &&
+      prev[prev.size() - suffix - 1] == next[next.size() - suffix - 1])
+    ++suffix;
+
+  const size_t prevEnd { prev.size() - suffix }, nextEnd { next.size() - suffix };
+  if(prevEnd - prefix == nextEnd - prefix) {
+    // changed in place: only the differing triangles are damaged
+    for(size_t i { prefix }; i < nextEnd; ++i) {
+      if(prev[i] == next[i])
+        continue;
+      addRegion(prev[i].bounds);
+      addRegion(next[i].bounds);
+    }
+    return;
+  }
+
+  // added or removed: the order of the triangles in between is unknown
+  for(size_t i { prefix }; i < prevEnd; ++i)
+    addRegion(prev[i].bounds);
+  for(size_t i { prefix }; i < nextEnd; ++i)
+    addRegion(next[i].bounds);
+}
+
+void DamageTracker::addRegion(const ClipRect &rect)
+{
+  // grow the region needing the least additional area
+  ClipRect *best {};
+  long long bestGrowth {};
+  for(ClipRect &region : m_regions) {
+    const long long growth { area(unite(region, rect)) - area(region) };
+    if(!best || growth < bestGrowth) {
+      best = &region;
+      bestGrowth = growth;
+    }
+  }
+
+  const bool overlaps { best && intersect(*best, rect) };
+  if(best && (overlaps || bestGrowth == 0 || m_regions.size() >= MAX_REGIONS))
+    *best = unite(*best, rect);
+  else
+    m_regions.push_back(rect);
+}
@@ -18,12 +18,18 @@
 #ifndef REAIMGUI_RENDERER_HPP
 #define REAIMGUI_RENDERER_HPP
 
+#include "frame_timings.hpp"
+
 #include <array>
+#include <cstdint>
 #include <memory>
+#include <vector>
 
 class Renderer;
 class RendererFactory;
 class Window;
+struct ImDrawData;
+struct ImDrawList;
 struct ImVec2;
 struct ImVec4;
 
@@ -39,6 +45,56 @@ struct RendererType {
   const char *id, *name, *displayName;
   std::unique_ptr<Renderer>(*creator)(RendererFactory *, Window *);
   RendererType *next;
+  mutable std::weak_ptr<void> globalData; // see RendererFactory
+};
+
+struct ClipRect {
+  ClipRect(long left, long top, long right, long bottom);
+  ClipRect(const ImVec4 &rect, const ImVec2 &offset, const ImVec2 &scale);
+  operator bool() const;
+  bool operator==(const ClipRect &) const = default;
+  long left, top, right, bottom;
+};
+
+// Merges consecutive draw commands sharing the same texture and clip rectangle
+// and omits the state changes that would have no effect.
+class DrawBatch {
+public:
+  struct Call {
+    ClipRect clipRect;
+    size_t texture;
+    unsigned int vtxOffset, idxOffset, elemCount; // from the start of the frame
+    bool setClipRect, setTexture;
+  };
+
+  struct Stats {
+    unsigned int commands, drawCalls, clipRects, textures;
+  };
+
+  void build(const ImDrawData *, const ImVec2 &clipScale);
+  auto begin() const { return m_calls.begin(); }
+  auto end()   const { return m_calls.end();   }
+  const Stats &stats() const { return m_stats; }
+
+private:
+  std::vector<Call> m_calls;
+  Stats m_stats;
+};
+
+// Deep copy of draw data remaining valid while Dear ImGui builds the next
+// frame. The storage of the draw lists is reused from one copy to the next.
+class DrawDataSnapshot {
+public:
+  DrawDataSnapshot();
+  DrawDataSnapshot(const DrawDataSnapshot &) = delete;
+  ~DrawDataSnapshot();
+
+  void copy(const ImDrawData *);
+  const ImDrawData *get() const { return m_drawData.get(); }
+
+private:
+  std::unique_ptr<ImDrawData> m_drawData;
+  std::vector<std::unique_ptr<ImDrawList>> m_lists;
 };
 
 class RendererFactory {
@@ -54,9 +110,85 @@ public:
   template<typename T>
   void setSharedData(T d) { m_shared = d; }
 
+  // shared by the renderers of every context
+  template<typename T>
+  auto getGlobalData() const { return std::static_pointer_cast<T>(m_type->globalData.lock()); }
+
+  template<typename T>
+  void setGlobalData(T d) { m_type->globalData = d; }
+
+  // draw calls of the previous frame summed across viewports
+  const DrawBatch::Stats &drawStats() const { return m_lastFrameStats; }
+  void addDrawStats(const DrawBatch::Stats &);
+  void nextFrame();
+
 protected:
   const RendererType *m_type;
   std::weak_ptr<void> m_shared;
+  DrawBatch::Stats m_frameStats, m_lastFrameStats;
+};
+
+// Sub-allocates ranges of a GPU buffer from one frame to the next without
+// waiting for the GPU, reallocating (orphaning) its storage only when full.
+// Sizes and offsets are in elements.
+class StreamBuffer {
+public:
+  struct Range {
+    size_t offset;
+    bool orphan; // storage must be reallocated with capacity() elements
+  };
+
+  StreamBuffer();
+
+  Range allocate(size_t size);
+  size_t capacity() const { return m_capacity; }
+
+private:
+  size_t m_capacity, m_offset;
+};
+
+// Identifies the content of a frame for skipping identical ones.
+// Not cryptographic: collisions are unlikely, not impossible.
+class FrameHash {
+public:
+  FrameHash();
+
+  void add(const void *data, size_t size);
+  template<typename T>
+  void add(const T &value) { add(&value, sizeof(value)); }
+  void addDrawData(const ImDrawData *);
+
+  uint64_t value() const { return m_value; }
+
+private:
+  uint64_t m_value;
+};
+
+// Finds the areas of a frame that differ from the previous one by comparing
+// their triangles, for repainting only those (in pixels).
+class DamageTracker {
+public:
+  static constexpr size_t MAX_REGIONS { 4 };
+
+  DamageTracker();
+
+  void update(const ImDrawData *, const ImVec2 &scale);
+  void invalidate() { m_invalid = true; } // next update damages everything
+  const std::vector<ClipRect> &regions() const { return m_regions; }
+
+private:
+  struct Triangle {
+    bool operator==(const Triangle &) const = default;
+    uint64_t hash;
+    ClipRect bounds;
+  };
+
+  void addRegion(const ClipRect &);
+
+  std::vector<Triangle> m_triangles, m_prevTriangles;
+  std::vector<ClipRect> m_regions;
+  ClipRect m_viewport;
+  bool m_invalid;
 };
 
 class Renderer {
@@ -75,6 +207,15 @@ public:
   virtual void setSize(ImVec2) = 0;
   virtual void render(void *) = 0;
   virtual void swapBuffers(void *) = 0;
+  // handles WM_PAINT, returns false for the default processing
+  virtual bool paint() { return false; }
+  // don't skip the next frame (eg. when render() did not present anything)
+  void invalidate() { m_frameHash = 0; }
+  // attaches to the new viewport of a reused window
+  void rebind();
+
+  // only the per-viewport stages are measured
+  const FrameTimings &timings() const { return m_timings; }
 
 protected:
   class ProjMtx {
@@ -87,13 +228,24 @@ protected:
   };
   static_assert(sizeof(ProjMtx) == sizeof(float[4][4]));
 
-  struct ClipRect {
-    ClipRect(const ImVec4 &rect, const ImVec2 &offset, const ImVec2 &scale);
-    operator bool() const;
-    long left, top, right, bottom;
-  };
+  const DrawBatch &batchDrawCalls(const ImDrawData *, const ImVec2 &clipScale);
+  // whether to render even if the draw data did not change
+  virtual bool isDirty() const { return false; }
+  // changes when textures shared with other contexts finish uploading
+  virtual unsigned int uploadGeneration() const { return 0; }
+  // vertical blanks to wait for when presenting, -1 for the default
+  int swapInterval() const;
 
   Window *m_window;
+  FrameTimings m_timings;
+
+private:
+  void renderWindow(void *);
+  void swapWindow(void *);
+
+  DrawBatch m_drawBatch;
+  uint64_t m_frameHash;
+  bool m_skipFrame;
 };
 
 #define REGISTER_RENDERER(priority, id, name, creator)     \
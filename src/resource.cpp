@@ -42,6 +42,7 @@ enum Flags {
 
 FlatSet<Resource *> Resource::g_rsx;
 Resource::Timer *Resource::g_timer;
+unsigned int Resource::g_ticks;
 
 static unsigned int  g_reentrant;
 static unsigned char g_consecutiveGcFrames;
@@ -109,6 +110,9 @@ void Resource::Timer::tick()
   if(blocked)
     return;
 
+  ++g_ticks;
+  Context::renderFrames();
+
   auto it { g_rsx.begin() };
   bool didGc { false };
 
@@ -54,6 +54,8 @@ public:
 
   static void destroyAll();
   static void bypassGCCheckOnce();
+  // incremented once per timer tick, before the frames of all contexts
+  static unsigned int tickCount() { return g_ticks; }
 
   template<typename T>
   bool isInstanceOf() const
@@ -71,6 +73,7 @@ private:
 
   static FlatSet<Resource *> g_rsx;
   static Timer *g_timer;
+  static unsigned int g_ticks;
 
   unsigned char m_keepAlive, m_flags;
 };
@@ -0,0 +1,482 @@
+/* ReaImGui: ReaScript binding for Dear ImGui
+ * Copyright (C) 2021-2024  Christian Fillion
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "software_renderer.hpp"
+
+#include "context.hpp"
+#include "texture.hpp"
+#include "window.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#  define HAVE_SSE2
+#  include <emmintrin.h>
+#endif
+
+#ifndef _WIN32
+#  include <swell/swell.h>
+#endif
+
+class SoftwareRenderer;
+REGISTER_RENDERER(100, software, "Software",
+  &Renderer::create<SoftwareRenderer>);
+
+class SoftwareRenderer final : public Renderer {
+public:
+  SoftwareRenderer(RendererFactory *, Window *);
+
+  void setSize(ImVec2) override {}
+  void render(void *) override;
+  void swapBuffers(void *) override;
+  bool paint() override;
+
+private:
+  void blit(HDC);
+
+  std::shared_ptr<RasterizerTextures> m_textures;
+  Rasterizer m_rasterizer;
+};
+
+// vertices are snapped to 1/256th of a pixel
+constexpr int SUBPIXEL_BITS { 8 }, SUBPIXEL_ONE { 1 << SUBPIXEL_BITS };
+// keeps the edge functions within 62 bits
+constexpr int64_t MAX_COORD { int64_t { 1 } << 29 };
+
+struct Rasterizer::Vertex {
+  int64_t x, y;
+  float u, v;
+  ImU32 col;
+};
+
+struct Rasterizer::Edge {
+  Edge(const Vertex &, const Vertex &);
+  int64_t at(int64_t x, int64_t y) const;
+
+  int64_t dx, dy, x, y, bias;
+};
+
+Rasterizer::Edge::Edge(const Vertex &from, const Vertex &to)
+  : dx { to.x - from.x }, dy { to.y - from.y }, x { from.x }, y { from.y }
+{
+  // top-left fill rule: pixels centered exactly on an edge shared by two
+  // triangles are only drawn (and blended) once
+  const bool topLeft { dy < 0 || (dy == 0 && dx > 0) };
+  bias = topLeft ? 0 : -1;
+}
+
+int64_t Rasterizer::Edge::at(const int64_t px, const int64_t py) const
+{
+  return (dx * (py - y)) - (dy * (px - x)) + bias;
+}
+
+static unsigned int div255(const unsigned int v)
+{
+  return (v + 128 + ((v + 128) >> 8)) >> 8;
+}
+
+static ImU32 modulate(const ImU32 a, const ImU32 b)
+{
+  ImU32 out {};
+  for(int shift {}; shift < 32; shift += 8)
+    out |= div255(((a >> shift) & 0xFF) * ((b >> shift) & 0xFF)) << shift;
+  return out;
+}
+
+static uint32_t blend(const uint32_t dst, const ImU32 src)
+{
+  const unsigned int alpha { src >> 24 }, invAlpha { 0xFF - alpha };
+  // from ImGui's RGBA to the framebuffer's BGRA, alpha blends as opaque white
+  const uint32_t color { 0xFF000000 | ((src & 0xFF) << 16) |
+                         (src & 0xFF00) | ((src >> 16) & 0xFF) };
+  if(alpha == 0xFF)
+    return color;
+
+  uint32_t out {};
+  for(int shift {}; shift < 32; shift += 8) {
+    const unsigned int s { (color >> shift) & 0xFF }, d { (dst >> shift) & 0xFF };
+    out |= div255((s * alpha) + (d * invAlpha)) << shift;
+  }
+  return out;
+}
+
+static void blendSpan(uint32_t *dst, size_t count, const ImU32 src)
+{
+  const unsigned int alpha { src >> 24 };
+  if(!alpha)
+    return;
+  else if(alpha == 0xFF) {
+    std::fill_n(dst, count, blend(0, src));
+    return;
+  }
+
+#ifdef HAVE_SSE2
+  // same arithmetic as blend() on four pixels at once
+  const uint32_t color { blend(0xFFFFFFFF, src | 0xFF000000) };
+  const __m128i zero     { _mm_setzero_si128() },
+                invAlpha { _mm_set1_epi16(0xFF - alpha) },
+                source   { _mm_add_epi16(
+                  _mm_mullo_epi16(_mm_unpacklo_epi8(
+                    _mm_set1_epi32(color), zero), _mm_set1_epi16(alpha)),
+                  _mm_set1_epi16(128)) };
+
+  for(; count >= 4; count -= 4, dst += 4) {
+    const __m128i pixels { _mm_loadu_si128(reinterpret_cast<__m128i *>(dst)) };
+    __m128i lo { _mm_unpacklo_epi8(pixels, zero) },
+            hi { _mm_unpackhi_epi8(pixels, zero) };
+    lo = _mm_add_epi16(_mm_mullo_epi16(lo, invAlpha), source);
+    hi = _mm_add_epi16(_mm_mullo_epi16(hi, invAlpha), source);
+    lo = _mm_srli_epi16(_mm_add_epi16(lo, _mm_srli_epi16(lo, 8)), 8);
+    hi = _mm_srli_epi16(_mm_add_epi16(hi, _mm_srli_epi16(hi, 8)), 8);
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(dst), _mm_packus_epi16(lo, hi));
+  }
+#endif
+
+  for(; count; --count, ++dst)
+    *dst = blend(*dst, src);
+}
+
+static ImU32 sample(const Rasterizer::Image &image, const float u, const float v)
+{
+  int x { static_cast<int>(std::floor(u * image.width))  % image.width  },
+      y { static_cast<int>(std::floor(v * image.height)) % image.height };
+  if(x < 0)
+    x += image.width;
+  if(y < 0)
+    y += image.height;
+
+  ImU32 texel;
+  std::memcpy(&texel, &image.pixels[((y * image.width) + x) * 4], sizeof(texel));
+  return texel;
+}
+
+Rasterizer::Rasterizer()
+  : m_width {}, m_height {}, m_scale { 1.f }
+{
+}
+
+void Rasterizer::resize(const int width, const int height)
+{
+  if(width == m_width && height == m_height)
+    return;
+
+  m_width  = std::max(0, width);
+  m_height = std::max(0, height);
+  m_pixels.assign(static_cast<size_t>(m_width) * m_height, 0);
+}
+
+void Rasterizer::clear()
+{
+  std::fill(m_pixels.begin(), m_pixels.end(), 0); // transparent black
+}
+
+void Rasterizer::setTransform(const ImVec2 &offset, const float scale)
+{
+  m_offset = offset;
+  m_scale  = scale;
+}
+
+Rasterizer::Vertex Rasterizer::transform(const ImDrawVert &vertex) const
+{
+  const auto snap { [this](const float pos, const float offset) {
+    const int64_t v
+      { std::llround((pos - offset) * m_scale * SUBPIXEL_ONE) };
+    return std::clamp(v, -MAX_COORD, MAX_COORD);
+  }};
+
+  return {
+    snap(vertex.pos.x, m_offset.x), snap(vertex.pos.y, m_offset.y),
+    vertex.uv.x, vertex.uv.y, vertex.col,
+  };
+}
+
+void Rasterizer::drawTriangles(const ImDrawVert *vertices,
+  const ImDrawIdx *indices, const unsigned int count,
+  const Image &image, const ClipRect &clipRect)
+{
+  if(image.pixels.empty())
+    return;
+
+  ClipRect scissor { clipRect };
+  scissor.left   = std::max(scissor.left,   0L);
+  scissor.top    = std::max(scissor.top,    0L);
+  scissor.right  = std::min(scissor.right,  static_cast<long>(m_width));
+  scissor.bottom = std::min(scissor.bottom, static_cast<long>(m_height));
+  if(!scissor)
+    return;
+
+  for(unsigned int i {}; i + 3 <= count; i += 3) {
+    drawTriangle(transform(vertices[indices[i]]),
+      transform(vertices[indices[i + 1]]), transform(vertices[indices[i + 2]]),
+      image, scissor);
+  }
+}
+
+void Rasterizer::drawTriangle(const Vertex &a, Vertex b, Vertex c,
+  const Image &image, const ClipRect &scissor)
+{
+  int64_t area { ((b.x - a.x) * (c.y - a.y)) - ((b.y - a.y) * (c.x - a.x)) };
+  if(area < 0) {
+    std::swap(b, c);
+    area = -area;
+  }
+  else if(!area)
+    return;
+
+  // pixels whose center is covered, within the scissor rectangle
+  const long minX { std::max(scissor.left,
+                      static_cast<long>(std::min({ a.x, b.x, c.x }) >> SUBPIXEL_BITS)) },
+             minY { std::max(scissor.top,
+                      static_cast<long>(std::min({ a.y, b.y, c.y }) >> SUBPIXEL_BITS)) },
+             maxX { std::min(scissor.right - 1,
+                      static_cast<long>(std::max({ a.x, b.x, c.x }) >> SUBPIXEL_BITS)) },
+             maxY { std::min(scissor.bottom - 1,
+                      static_cast<long>(std::max({ a.y, b.y, c.y }) >> SUBPIXEL_BITS)) };
+  if(minX > maxX || minY > maxY)
+    return;
+
+  // solid shapes sample ImGui's white pixel with a single color
+  const bool sameColor { a.col == b.col && b.col == c.col },
+             sameUV    { a.u == b.u && b.u == c.u && a.v == b.v && b.v == c.v };
+  if(sameColor && !(a.col >> 24))
+    return;
+  const ImU32 texel { sameUV ? sample(image, a.u, a.v) : 0 },
+              solid { modulate(texel, a.col) };
+
+  // barycentric weights of b and c
+  const Edge edgeA { b, c }, edgeB { c, a }, edgeC { a, b };
+  const int64_t stepA { -edgeA.dy * SUBPIXEL_ONE },
+                stepB { -edgeB.dy * SUBPIXEL_ONE },
+                stepC { -edgeC.dy * SUBPIXEL_ONE };
+  const float invArea { 1.f / static_cast<float>(area) };
+
+  for(long y { minY }; y <= maxY; ++y) {
+    const int64_t px { (int64_t { minX } << SUBPIXEL_BITS) + (SUBPIXEL_ONE / 2) },
+                  py { (int64_t { y }    << SUBPIXEL_BITS) + (SUBPIXEL_ONE / 2) };
+    int64_t wA { edgeA.at(px, py) }, wB { edgeB.at(px, py) }, wC { edgeC.at(px, py) };
+
+    long x { minX };
+    while(x <= maxX && (wA | wB | wC) < 0)
+      wA += stepA, wB += stepB, wC += stepC, ++x;
+    const long spanStart { x };
+    const int64_t spanB { wB }, spanC { wC };
+    while(x <= maxX && (wA | wB | wC) >= 0)
+      wA += stepA, wB += stepB, wC += stepC, ++x;
+    if(x == spanStart)
+      continue;
+
+    uint32_t *row { &m_pixels[(y * m_width) + spanStart] };
+    if(sameColor && sameUV) {
+      blendSpan(row, x - spanStart, solid);
+      continue;
+    }
+
+    float weightB { spanB * invArea }, weightC { spanC * invArea };
+    const float stepWeightB { stepB * invArea }, stepWeightC { stepC * invArea };
+    for(long i { spanStart }; i < x; ++i, ++row) {
+      const auto lerp { [weightB, weightC](const float va, const float vb, const float vc) {
+        return va + (weightB * (vb - va)) + (weightC * (vc - va));
+      }};
+
+      ImU32 col { a.col };
+      if(!sameColor) {
+        col = 0;
+        for(int shift {}; shift < 32; shift += 8) {
+          const float channel { lerp((a.col >> shift) & 0xFF,
+            (b.col >> shift) & 0xFF, (c.col >> shift) & 0xFF) };
+          col |= static_cast<ImU32>(std::clamp(channel + .5f, 0.f, 255.f)) << shift;
+        }
+      }
+
+      *row = blend(*row, modulate(sameUV ? texel :
+        sample(image, lerp(a.u, b.u, c.u), lerp(a.v, b.v, c.v)), col));
+
+      weightB += stepWeightB;
+      weightC += stepWeightC;
+    }
+  }
+}
+
+void Rasterizer::draw(const ImDrawData *drawData, const DrawBatch &batch,
+  const RasterizerTextures &textures)
+{
+  m_vertices.clear();
+  m_indices.clear();
+  for(int i {}; i < drawData->CmdListsCount; ++i) {
+    const ImDrawList *cmdList { drawData->CmdLists[i] };
+    m_vertices.insert(m_vertices.end(),
+      cmdList->VtxBuffer.begin(), cmdList->VtxBuffer.end());
+    m_indices.insert(m_indices.end(),
+      cmdList->IdxBuffer.begin(), cmdList->IdxBuffer.end());
+  }
+
+  for(const DrawBatch::Call &call : batch) {
+    drawTriangles(&m_vertices[call.vtxOffset], &m_indices[call.idxOffset],
+      call.elemCount, textures[call.texture], call.clipRect);
+  }
+}
+
+void Rasterizer::readPixels(unsigned char *rgba) const
+{
+  // the framebuffer holds colors premultiplied by their coverage
+  for(const uint32_t pixel : m_pixels) {
+    const unsigned int alpha { pixel >> 24 };
+    const auto channel { [pixel, alpha](const int shift) -> unsigned char {
+      if(!alpha)
+        return 0;
+      const unsigned int value { (pixel >> shift) & 0xFF };
+      return std::min(0xFFu, ((value * 0xFF) + (alpha / 2)) / alpha);
+    }};
+
+    *rgba++ = channel(16);
+    *rgba++ = channel(8);
+    *rgba++ = channel(0);
+    *rgba++ = alpha;
+  }
+}
+
+static void copyRegion(Rasterizer::Image &image, const unsigned char *pixels,
+  const TextureCmd::Region &region)
+{
+  const size_t rowSize ((region.right - region.left) * 4);
+  for(int y { region.top }; y < region.bottom; ++y) {
+    const size_t offset ((((y * image.width) + region.left) * 4));
+    std::memcpy(&image.pixels[offset], pixels + offset, rowSize);
+  }
+}
+
+void RasterizerTextures::update(const TextureManager *manager)
+{
+  using namespace std::placeholders;
+  manager->update(&m_cookie,
+    std::bind(&RasterizerTextures::textureCommand, this, _1));
+}
+
+void RasterizerTextures::textureCommand(const TextureCmd &cmd)
+{
+  switch(cmd.type) {
+  case TextureCmd::Insert:
+    m_images.insert(m_images.begin() + cmd.offset, cmd.size, {});
+    break;
+  case TextureCmd::Update:
+  case TextureCmd::UpdateRegion:
+    break;
+  case TextureCmd::Remove:
+    m_images.erase(m_images.begin() + cmd.offset,
+                   m_images.begin() + cmd.offset + cmd.size);
+    return;
+  }
+
+  for(size_t i {}; i < cmd.size; ++i) {
+    Rasterizer::Image &image { m_images[cmd.offset + i] };
+    int width, height;
+    const unsigned char *pixels { cmd[i].getPixels(&width, &height) };
+
+    if(cmd.type == TextureCmd::UpdateRegion &&
+        width == image.width && height == image.height) {
+      copyRegion(image, pixels, cmd.region);
+      continue;
+    }
+
+    image.width  = width;
+    image.height = height;
+    image.pixels.assign(pixels, pixels + (static_cast<size_t>(width) * height * 4));
+  }
+
+  cmd.manager->addUploads(cmd.size);
+}
+
+SoftwareRenderer::SoftwareRenderer(RendererFactory *factory, Window *window)
+  : Renderer { window }
+{
+  m_textures = factory->getSharedData<RasterizerTextures>();
+  if(!m_textures) {
+    m_textures = std::make_shared<RasterizerTextures>();
+    factory->setSharedData(m_textures);
+  }
+}
+
+void SoftwareRenderer::render(void *)
+{
+  m_textures->update(m_window->context()->textureManager());
+
+  const ImGuiViewport *viewport { m_window->viewport() };
+  const ImDrawData *drawData { viewport->DrawData };
+  const ImVec2 scale { viewport->DpiScale, viewport->DpiScale };
+
+  m_rasterizer.resize(drawData->DisplaySize.x * scale.x,
+                      drawData->DisplaySize.y * scale.y);
+  if(!(viewport->Flags & ImGuiViewportFlags_NoRendererClear))
+    m_rasterizer.clear();
+  m_rasterizer.setTransform(drawData->DisplayPos, scale.x);
+  m_rasterizer.draw(drawData, batchDrawCalls(drawData, scale), *m_textures);
+}
+
+void SoftwareRenderer::swapBuffers(void *)
+{
+  HWND hwnd { m_window->nativeHandle() };
+#ifdef _WIN32
+  if(HDC dc { GetDC(hwnd) }) {
+    blit(dc);
+    ReleaseDC(hwnd, dc);
+  }
+#else
+  InvalidateRect(hwnd, nullptr, false); // post a WM_PAINT
+#endif
+}
+
+bool SoftwareRenderer::paint()
+{
+  PAINTSTRUCT ps;
+  if(BeginPaint(m_window->nativeHandle(), &ps)) {
+    blit(ps.hdc);
+    EndPaint(m_window->nativeHandle(), &ps);
+  }
+
+  return true;
+}
+
+void SoftwareRenderer::blit(HDC dc)
+{
+  const int width { m_rasterizer.width() }, height { m_rasterizer.height() };
+
+#ifdef _WIN32
+  const BITMAPINFO info {
+    .bmiHeader {
+      .biSize        = sizeof(BITMAPINFOHEADER),
+      .biWidth       = width,
+      .biHeight      = -height, // top-down
+      .biPlanes      = 1,
+      .biBitCount    = 32,
+      .biCompression = BI_RGB,
+    },
+  };
+  SetDIBitsToDevice(dc, 0, 0, width, height, 0, 0, 0, height,
+    m_rasterizer.pixels(), &info, DIB_RGB_COLORS);
+#else
+#  ifdef __APPLE__
+  // SWELL's device contexts use points on macOS
+  const float scale { m_window->viewport()->DpiScale };
+#  else
+  constexpr float scale { 1.f };
+#  endif
+  StretchBltFromMem(dc, 0, 0, width / scale, height / scale,
+    m_rasterizer.pixels(), width, height, width);
+#endif
+}
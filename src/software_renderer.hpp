@@ -0,0 +1,87 @@
+/* ReaImGui: ReaScript binding for Dear ImGui
+ * Copyright (C) 2021-2024  Christian Fillion
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef REAIMGUI_SOFTWARE_RENDERER_HPP
+#define REAIMGUI_SOFTWARE_RENDERER_HPP
+
+#include "renderer.hpp"
+#include "texture.hpp"
+
+#include <cstdint>
+#include <vector>
+
+#include <imgui/imgui.h>
+
+class RasterizerTextures;
+
+// Draws textured, alpha-blended and scissored triangles on the CPU into a
+// 32-bit framebuffer (0xAARRGGBB, the native format of GDI and LICE).
+// Textures are sampled using the nearest texel with repeat wrapping.
+class Rasterizer {
+public:
+  struct Image {
+    int width, height;
+    std::vector<unsigned char> pixels; // RGBA, as given by the texture manager
+  };
+
+  Rasterizer();
+
+  void resize(int width, int height);
+  void clear();
+  void setTransform(const ImVec2 &offset, float scale);
+  void drawTriangles(const ImDrawVert *, const ImDrawIdx *, unsigned int count,
+                     const Image &, const ClipRect &);
+  // draws the calls of a batch built from the same draw data
+  void draw(const ImDrawData *, const DrawBatch &, const RasterizerTextures &);
+  // straight (non-premultiplied) RGBA, width * height * 4 bytes
+  void readPixels(unsigned char *rgba) const;
+
+  int width()  const { return m_width;  }
+  int height() const { return m_height; }
+  const uint32_t *pixels() const { return m_pixels.data(); }
+  uint32_t pixel(int x, int y) const { return m_pixels[(y * m_width) + x]; }
+
+private:
+  struct Vertex;
+  struct Edge;
+
+  Vertex transform(const ImDrawVert &) const;
+  void drawTriangle(const Vertex &, Vertex, Vertex,
+                    const Image &, const ClipRect &);
+
+  int m_width, m_height;
+  ImVec2 m_offset;
+  float m_scale;
+  std::vector<uint32_t> m_pixels;
+  std::vector<ImDrawVert> m_vertices;
+  std::vector<ImDrawIdx>  m_indices;
+};
+
+// CPU copies of the textures of a TextureManager
+class RasterizerTextures {
+public:
+  void update(const TextureManager *);
+  const Rasterizer::Image &operator[](size_t i) const { return m_images[i]; }
+
+private:
+  void textureCommand(const TextureCmd &);
+
+  TextureCookie m_cookie;
+  std::vector<Rasterizer::Image> m_images;
+};
+
+#endif
@@ -19,129 +19,232 @@
 
 #include <algorithm>
 #include <imgui/imgui.h>
+#include <cassert>
 #include <iterator>
-#include <numeric>
-
-class Comparator {
-public:
-  Comparator(const TextureManager *manager) : m_manager { manager } {}
-
-  bool operator()(const size_t ida, const size_t idb) const
-  {
-    const Texture &a { m_manager->get(ida) }, &b { m_manager->get(idb) };
-    if(a.object() == b.object())
-      return a.scale() < b.scale();
-    return a.object() < b.object();
-  }
-
-  bool operator()(const size_t index, void *user) const
-  {
-    return m_manager->get(index).object() < user;
-  }
-
-  bool operator()(void *user, const size_t index) const
-  {
-    return user < m_manager->get(index).object();
-  }
-
-  bool operator()(const size_t index, const float scale) const
-  {
-    return m_manager->get(index).scale() < scale;
-  }
+#include <map>
+#include <optional>
 
-  bool operator()(const float scale, const size_t index) const
-  {
-    return scale < m_manager->get(index).scale();
-  }
+// Renderers lagging further behind fall back to a full diff of the textures
+constexpr size_t MAX_JOURNAL_SIZE { 256 };
 
-private:
-  const TextureManager *m_manager;
-};
+void Texture::measure()
+{
+  // renderers may reuse the texture uploaded by another context without
+  // reading its pixels: the size is recorded here for the budget instead
+  int width {}, height {};
+  if(m_getPixels)
+    getPixels(&width, &height);
+  m_bytes = static_cast<size_t>(width) * height * 4;
+}
 
 TextureManager::TextureManager()
-  : m_version {}
+  : m_version {}, m_journalBase {}, m_budget {},
+    m_evictions {}, m_lastFrameUploads {}, m_uploads {}
 {
 }
 
 size_t TextureManager::touch(Texture &&tex)
 {
-  const Comparator comparator { this };
-  const auto [begin, end]
-    { std::equal_range(m_sorted.begin(), m_sorted.end(), tex.m_user, comparator) };
-  auto it { std::lower_bound(begin, end, tex.m_scale, comparator) };
+  const auto [begin, end] { m_index.equal_range(tex.m_user) };
+  auto it { std::find_if(begin, end, [this, &tex](const auto &pair) {
+    return m_textures[pair.second].isSame(tex.m_user, tex.m_scale);
+  }) };
 
-  if(it == end || !m_textures[*it].isSame(tex.m_user, tex.m_scale)) {
+  if(it == end) {
     tex.m_version = m_version;
-    const Texture &inserted { m_textures.emplace_back(std::move(tex)) };
-    it = m_sorted.emplace(it, &inserted - &m_textures.front());
+    tex.measure();
+    it = m_index.emplace(tex.m_user, m_textures.size());
+    record(TextureCmd::Insert, m_textures.size());
+    m_textures.emplace_back(std::move(tex));
     ++m_version;
   }
 
-  m_textures[*it].m_lastTimeActive = ImGui::GetTime();
+  m_textures[it->second].m_lastTimeActive = ImGui::GetTime();
 
-  return *it;
+  return it->second;
 }
 
 void TextureManager::invalidate(void *object)
 {
-  const Comparator comparator { this };
-  const auto [begin, end]
-    { equal_range(m_sorted.begin(), m_sorted.end(), object, comparator) };
+  invalidate(object, nullptr);
+}
+
+void TextureManager::invalidate(void *object, const TextureCmd::Region &region)
+{
+  invalidate(object, &region);
+}
 
-  for(auto it { begin }; it < end; ++it)
-    ++(m_textures[*it].m_version);
+void TextureManager::invalidate(void *object, const TextureCmd::Region *region)
+{
+  const auto [begin, end] { m_index.equal_range(object) };
+
+  // sorted to coalesce the journal entries of adjacent scales
+  std::vector<size_t> indices;
+  std::transform(begin, end, std::back_inserter(indices),
+    [](const auto &pair) { return pair.second; });
+  std::sort(indices.begin(), indices.end());
+
+  for(const size_t index : indices) {
+    Texture &tex { m_textures[index] };
+    ++tex.m_version;
+    if(region)
+      record(TextureCmd::UpdateRegion, index, region);
+    else {
+      tex.measure();
+      record(TextureCmd::Update, index);
+    }
+  }
 
   ++m_version;
 }
 
 void TextureManager::remove(void *object)
 {
-  const Comparator comparator { this };
-  const auto [begin, end]
-    { std::equal_range(m_sorted.begin(), m_sorted.end(), object, comparator) };
+  if(!m_index.count(object))
+    return;
+
+  eraseIf([object](const Texture &tex) { return tex.object() == object; });
+}
 
-  if(begin == end)
+void TextureManager::cleanup()
+{
+  m_lastFrameUploads = m_uploads;
+  m_uploads = 0;
+
+  const float now { static_cast<float>(ImGui::GetTime()) },
+              ttl { ImGui::GetIO().ConfigMemoryCompactTimer };
+  const auto cutoff { now - ttl };
+  eraseIf([this, cutoff](const Texture &tex) {
+    if(!tex.isValid())
+      return true;
+    else if(tex.m_lastTimeActive > cutoff || !tex.compact())
+      return false;
+    ++m_evictions;
+    return true;
+  });
+
+  if(m_budget)
+    evictOverBudget(now);
+}
+
+void TextureManager::evictOverBudget(const float activeTime)
+{
+  size_t bytes { residentBytes() };
+  if(bytes <= m_budget)
     return;
 
-  std::sort(begin, end);
-  const size_t first { *begin }, last { *std::prev(end) };
-
-  size_t i {};
-  m_textures.erase(std::remove_if(m_textures.begin(), m_textures.end(),
-  [&](const Texture &) {
-    const bool rm { i >= first && i <= last };
-    ++i;
-    return rm;
-  }), m_textures.end());
-
-  const auto rangeSize { end - begin };
-  for(size_t &i : m_sorted) {
-    if(i >= *begin)
-      i -= rangeSize;
+  // textures used in the previous frame are kept to avoid re-uploading
+  // them every frame when the budget is too small for a single frame
+  std::vector<size_t> candidates;
+  for(size_t i {}; i < m_textures.size(); ++i) {
+    if(m_textures[i].m_lastTimeActive < activeTime)
+      candidates.push_back(i);
+  }
+  std::sort(candidates.begin(), candidates.end(),
+    [this](const size_t a, const size_t b) {
+      return m_textures[a].m_lastTimeActive < m_textures[b].m_lastTimeActive;
+    });
+
+  std::vector<bool> evict(m_textures.size());
+  for(const size_t i : candidates) {
+    if(bytes <= m_budget)
+      break;
+    const Texture &tex { m_textures[i] };
+    if(!tex.m_bytes || !tex.compact())
+      continue;
+    evict[i] = true;
+    bytes -= tex.m_bytes;
+    ++m_evictions;
   }
 
-  m_sorted.erase(begin, end);
-  ++m_version;
+  // eraseIf tests each texture before moving it
+  eraseIf([this, &evict](const Texture &tex) {
+    return evict[&tex - m_textures.data()];
+  });
 }
 
-void TextureManager::cleanup()
+size_t TextureManager::residentBytes() const
 {
-  const float ttl { ImGui::GetIO().ConfigMemoryCompactTimer };
-  const auto cutoff { static_cast<float>(ImGui::GetTime()) - ttl };
-  const auto isExpired { [cutoff](const Texture &tex) {
-    return !tex.isValid() || (tex.m_lastTimeActive <= cutoff && tex.compact());
-  }};
-  const auto newEnd
-    { std::remove_if(m_textures.begin(), m_textures.end(), isExpired) };
+  size_t bytes {};
+  for(const Texture &tex : m_textures)
+    bytes += tex.m_bytes;
+  return bytes;
+}
 
-  if(newEnd == m_textures.end())
-    return;
+TextureManager::Stats TextureManager::stats() const
+{
+  return { m_textures.size(), residentBytes(), m_lastFrameUploads, m_evictions };
+}
+
+template<typename Pred>
+bool TextureManager::eraseIf(const Pred &pred)
+{
+  size_t removed {};
+  for(size_t i {}; i < m_textures.size(); ++i) {
+    if(pred(m_textures[i]))
+      record(TextureCmd::Remove, i - removed++); // offset once previous are gone
+    else if(removed)
+      m_textures[i - removed] = std::move(m_textures[i]);
+  }
+
+  if(!removed)
+    return false;
 
+  m_textures.erase(m_textures.end() - removed, m_textures.end());
+  reindex();
   ++m_version;
-  m_textures.erase(newEnd, m_textures.end());
-  m_sorted.resize(m_textures.size());
-  std::iota(m_sorted.begin(), m_sorted.end(), 0);
-  std::sort(m_sorted.begin(), m_sorted.end(), Comparator { this });
+  return true;
+}
+
+void TextureManager::reindex()
+{
+  // indices are positions in m_textures: they all shift after an erasure
+  m_index.clear();
+  m_index.reserve(m_textures.size());
+  for(size_t i {}; i < m_textures.size(); ++i)
+    m_index.emplace(m_textures[i].m_user, i);
+}
+
+void TextureManager::record(const TextureCmd::Type type, const size_t offset,
+  const TextureCmd::Region *region)
+{
+  if(!m_journal.empty() && m_journal.back().type == type) {
+    JournalEntry &last { m_journal.back() };
+    bool merged { false };
+
+    switch(type) {
+    case TextureCmd::Insert: // always appending at the end
+      ++last.size, merged = true;
+      break;
+    case TextureCmd::Update: // replaying updates is idempotent
+      if(offset >= last.offset && offset <= last.offset + last.size) {
+        last.size = std::max(last.size, offset - last.offset + 1);
+        merged = true;
+      }
+      break;
+    case TextureCmd::UpdateRegion:
+      if(offset == last.offset)
+        last.region.merge(*region), merged = true;
+      break;
+    case TextureCmd::Remove:
+      if(offset == last.offset && last.to >= m_version)
+        ++last.size, merged = true;
+      break;
+    }
+
+    if(merged) {
+      last.to = m_version + 1;
+      return;
+    }
+  }
+
+  m_journal.push_back({ m_version, m_version + 1, type, offset, 1,
+                        region ? *region : TextureCmd::Region {} });
+
+  if(m_journal.size() > MAX_JOURNAL_SIZE) {
+    m_journalBase = m_journal.front().to;
+    m_journal.pop_front();
+  }
 }
 
 void TextureManager::update(TextureCookie *cookie, const CommandRunner &runner) const
@@ -155,12 +258,122 @@ void TextureManager::update(TextureCookie *cookie, const CommandRunner &runner)
   // allow selecting only textures of a given scale (eg. if the GDK backend
   // ever gain multi-DPI capability.)
 
-  const auto NullCmd { static_cast<TextureCmd::Type>(-1) };
-
-  if(m_version == cookie->m_version)
+  if(isSynced(*cookie))
     return;
 
+  if(!replay(cookie, runner))
+    diff(cookie, runner);
+
   cookie->m_version = m_version;
+  assert(cookie->m_crumbs.size() == m_textures.size());
+}
+
+bool TextureManager::isSynced(const TextureCookie &cookie) const
+{
+  return m_version == cookie.m_version;
+}
+
+bool TextureManager::replay(TextureCookie *cookie, const CommandRunner &runner) const
+{
+  // Replaying the journal is only possible if the cookie is recent enough and
+  // if the commands are valid for the current state of the textures: removals
+  // must come first (their offsets would be stale otherwise) and insertions
+  // cannot be mixed with removals (to let diff() turn reinsertions into
+  // updates).
+
+  if(cookie->m_version < m_journalBase)
+    return false;
+
+  const auto first { std::find_if(m_journal.begin(), m_journal.end(),
+    [cookie](const JournalEntry &entry) { return entry.to > cookie->m_version; }) };
+
+  bool hasInsert {}, hasUpdate {}, hasRemove {};
+  for(auto it { first }; it != m_journal.end(); ++it) {
+    switch(it->type) {
+    case TextureCmd::Insert:
+      hasInsert = true;
+      break;
+    case TextureCmd::Update:
+    case TextureCmd::UpdateRegion:
+      hasUpdate = true;
+      break;
+    case TextureCmd::Remove:
+      if(hasUpdate || it->from < cookie->m_version)
+        return false;
+      hasRemove = true;
+      break;
+    }
+
+    if(hasInsert && hasRemove)
+      return false;
+  }
+
+  // textures to upload again, either entirely (nullopt) or partially
+  std::map<size_t, std::optional<TextureCmd::Region>> updates;
+
+  for(auto it { first }; it != m_journal.end(); ++it) {
+    if(it->type == TextureCmd::Remove) {
+      const TextureCmd cmd { this, TextureCmd::Remove, it->offset, it->size };
+      runner(cmd);
+      cookie->doCommand(cmd);
+      continue;
+    }
+    else if(it->type == TextureCmd::Insert)
+      continue; // all insertions are sent at once below
+
+    // skip textures inserted (and uploaded) later or already up to date
+    const size_t end
+      { std::min(it->offset + it->size, cookie->m_crumbs.size()) };
+    for(size_t i { it->offset }; i < end; ++i) {
+      if(cookie->m_crumbs[i].version == m_textures[i].m_version)
+        continue;
+
+      const auto [update, inserted] { updates.try_emplace(i, it->region) };
+      if(it->type == TextureCmd::Update)
+        update->second = std::nullopt;
+      else if(!inserted && update->second)
+        update->second->merge(it->region);
+    }
+  }
+
+  TextureCmd cmd { this, TextureCmd::Update };
+  const auto flush { [&] {
+    if(!cmd.size)
+      return;
+    runner(cmd);
+    cookie->doCommand(cmd);
+    cmd.size = 0;
+  }};
+  for(const auto &[index, region] : updates) {
+    if(region || index != cmd.offset + cmd.size)
+      flush();
+
+    if(region) {
+      const TextureCmd regionCmd
+        { this, TextureCmd::UpdateRegion, index, 1, *region };
+      runner(regionCmd);
+      cookie->doCommand(regionCmd);
+    }
+    else if(!cmd.size++)
+      cmd.offset = index;
+  }
+  flush();
+
+  if(cookie->m_crumbs.size() < m_textures.size()) {
+    const size_t offset { cookie->m_crumbs.size() };
+    const TextureCmd cmd
+      { this, TextureCmd::Insert, offset, m_textures.size() - offset };
+    runner(cmd);
+    cookie->doCommand(cmd);
+  }
+
+  return true;
+}
+
+void TextureManager::diff(TextureCookie *cookie, const CommandRunner &runner) const
+{
+  const auto NullCmd { static_cast<TextureCmd::Type>(-1) };
+
   cookie->m_crumbs.reserve(m_textures.size());
 
   TextureCmd cmd { this, NullCmd };
@@ -190,7 +403,8 @@ void TextureManager::update(TextureCookie *cookie, const CommandRunner &runner)
       // execute the previous completed command
       runner(cmd);
       cookie->doCommand(cmd);
-      j = i;
+      if(cmd.type == TextureCmd::Remove)
+        j -= cmd.size;
     }
 
     // prepare the next command
@@ -242,7 +456,8 @@ void TextureCookie::doCommand(const TextureCmd &cmd)
       });
     break;
   }
-  case TextureCmd::Update: {
+  case TextureCmd::Update:
+  case TextureCmd::UpdateRegion: {
     auto texture { &cmd.manager->get(cmd.offset) };
     const auto end { crumb + cmd.size };
     while(crumb < end)
@@ -254,3 +469,11 @@ void TextureCookie::doCommand(const TextureCmd &cmd)
     break;
   }
 }
+
+void TextureCmd::Region::merge(const Region &other)
+{
+  left   = std::min(left,   other.left);
+  top    = std::min(top,    other.top);
+  right  = std::max(right,  other.right);
+  bottom = std::max(bottom, other.bottom);
+}
@@ -18,14 +18,16 @@
 #ifndef REAIMGUI_TEXTURE_HPP
 #define REAIMGUI_TEXTURE_HPP
 
+#include <deque>
 #include <functional>
+#include <unordered_map>
 #include <vector>
 
 class TextureCookie;
 class TextureManager;
-struct TextureCmd;
 
 using TextureVersion = unsigned int;
+using TextureShareId = unsigned long long; // 0 = not shareable
 
 class Texture {
 public:
@@ -35,14 +37,17 @@ public:
   using IsValidFunc   = bool(*)(void *object);
 
   Texture(void *user, float scale, GetPixelsFunc getPixels,
-    IsValidFunc isValid = nullptr, CompactFunc compact = nullptr)
+    IsValidFunc isValid = nullptr, CompactFunc compact = nullptr,
+    TextureShareId shareId = 0)
     : m_user { user }, m_scale { scale }, m_getPixels { getPixels },
-      m_compact { compact }, m_isValid { isValid },
-      m_version { 0u }, m_lastTimeActive { 0.f }
+      m_compact { compact }, m_isValid { isValid }, m_shareId { shareId },
+      m_version { 0u }, m_lastTimeActive { 0.f }, m_bytes { 0u }
   {}
 
   void *object() const { return m_user; }
   float scale()  const { return m_scale; }
+  // identifies the pixels across contexts for renderers to share the texture
+  TextureShareId shareId() const { return m_shareId; }
 
   bool isSame(void *user, const float scale) const
   {
@@ -68,19 +73,44 @@ private:
   friend TextureManager;
   friend TextureCookie;
 
+  void measure();
+
   void *m_user;
   float m_scale;
   GetPixelsFunc m_getPixels;
   CompactFunc   m_compact;
   IsValidFunc   m_isValid;
+  TextureShareId m_shareId;
   TextureVersion m_version;
   float m_lastTimeActive;
+  size_t m_bytes; // size of the pixels, updated when inserted or invalidated
+};
+
+struct TextureCmd {
+  struct Region {
+    int left, top, right, bottom; // in pixels
+    void merge(const Region &);
+  };
+
+  const TextureManager *manager;
+  enum Type { Insert, Update, UpdateRegion, Remove };
+  Type type;
+  size_t offset, size;
+  Region region; // for UpdateRegion
+
+  const Texture &operator[](size_t i) const;
 };
 
 class TextureManager {
 public:
   using CommandRunner = std::function<void (const TextureCmd &)>;
 
+  struct Stats {
+    size_t textures, bytes;
+    unsigned int uploads;   // during the previous frame, see addUploads
+    unsigned int evictions; // since creation
+  };
+
   TextureManager();
 
   size_t touch(Texture &&);
@@ -88,17 +118,52 @@ public:
   size_t touch(Args &&...args) { return touch(Texture { args... }); }
   const Texture &get(size_t i) const { return m_textures[i]; }
   void invalidate(void *object);
+  // the region must be within the bounds of every scale of the object
+  void invalidate(void *object, const TextureCmd::Region &);
 
   // invalidates all indices given by touch()
   void cleanup();
   void remove(void *object);
 
   void update(TextureCookie *, const CommandRunner &) const;
+  // whether update() has no command to run for the cookie
+  bool isSynced(const TextureCookie &) const;
+  // changes whenever a texture is added, modified or removed
+  TextureVersion version() const { return m_version; }
+
+  // 0 for no limit, otherwise cleanup() evicts the least recently used
+  size_t budget() const { return m_budget; }
+  void setBudget(size_t bytes) { m_budget = bytes; }
+  Stats stats() const;
+  // called by the renderers for every texture they actually upload
+  void addUploads(unsigned int count) const { m_uploads += count; }
 
 private:
+  // changes made between versions [from, to)
+  struct JournalEntry {
+    TextureVersion from, to;
+    TextureCmd::Type type;
+    size_t offset, size;
+    TextureCmd::Region region;
+  };
+
+  template<typename Pred> bool eraseIf(const Pred &);
+  void evictOverBudget(float activeTime);
+  size_t residentBytes() const;
+  void reindex();
+  void invalidate(void *object, const TextureCmd::Region *);
+  void record(TextureCmd::Type, size_t offset,
+    const TextureCmd::Region * = nullptr);
+  bool replay(TextureCookie *, const CommandRunner &) const;
+  void diff(TextureCookie *, const CommandRunner &) const;
+
   std::vector<Texture> m_textures;
-  std::vector<size_t> m_sorted;
-  TextureVersion m_version;
+  std::unordered_multimap<void *, size_t> m_index; // one entry per scale
+  std::deque<JournalEntry> m_journal;
+  TextureVersion m_version, m_journalBase;
+  size_t m_budget;
+  unsigned int m_evictions, m_lastFrameUploads;
+  mutable unsigned int m_uploads;
 };
 
 class TextureCookie {
@@ -120,16 +185,9 @@ private:
   std::vector<Crumb> m_crumbs;
 };
 
-struct TextureCmd {
-  const TextureManager *manager;
-  enum Type { Insert, Update, Remove };
-  Type type;
-  size_t offset, size;
-
-  const Texture &operator[](const size_t i) const
-  {
-    return manager->get(offset + i);
-  }
-};
+inline const Texture &TextureCmd::operator[](const size_t i) const
+{
+  return manager->get(offset + i);
+}
 
 #endif
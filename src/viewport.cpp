@@ -20,6 +20,7 @@
 #include "context.hpp"
 #include "docker.hpp"
 #include "error.hpp"
+#include "offscreen_viewport.hpp"
 #include "platform.hpp"
 #include "viewport_forwarder.hpp"
 #include "window.hpp"
@@ -52,10 +53,23 @@ private:
 
 static void createViewport(ImGuiViewport *viewport)
 {
+  Context *ctx { Context::current() };
   Viewport *instance;
 
-  if(Docker *docker { Context::current()->dockers().findByViewport(viewport) })
+  if(ctx->isHeadless()) {
+    const bool renderThread
+      { (ctx->IO().ConfigFlags & ReaImGuiConfigFlags_RenderThread) != 0 };
+    instance = new OffscreenViewport
+      { viewport, ctx->textureManager(), renderThread };
+  }
+  else if(Docker *docker { ctx->dockers().findByViewport(viewport) })
     instance = new DockerHost { docker, viewport };
+  else if((instance = ctx->windowPool().take(viewport))) {
+    // already created, along with its renderer
+    viewport->PlatformUserData = instance;
+    viewport->PlatformHandle   = instance->nativeHandle();
+    return;
+  }
   else
     instance = Platform::createWindow(viewport);
 
@@ -75,7 +89,8 @@ static void createViewport(ImGuiViewport *viewport)
 
 static void destroyViewport(ImGuiViewport *viewport)
 {
-  if(Viewport *instance { static_cast<Viewport *>(viewport->PlatformUserData) }) {
+  Viewport *instance { static_cast<Viewport *>(viewport->PlatformUserData) };
+  if(instance && !instance->context()->windowPool().give(instance)) {
     instance->destroy();
     delete instance;
   }
@@ -113,6 +128,7 @@ void Viewport::install()
   pio.Platform_UpdateWindow       = &Forwarder::wrap<&Viewport::update>;
   pio.Platform_GetWindowDpiScale  = &Forwarder::wrap<&Viewport::scaleFactor>;
   pio.Platform_OnChangedViewport  = &Forwarder::wrap<&Viewport::onChanged>;
+  pio.Platform_RenderWindow       = &Forwarder::wrap<&Viewport::render>;
 
   ImGuiIO &io { ImGui::GetIO() };
   io.SetPlatformImeDataFn = &Forwarder::wrap<&Viewport::setIME>;
@@ -59,6 +59,8 @@ public:
   virtual float scaleFactor() const = 0;
   virtual void onChanged() = 0;
   virtual void setIME(ImGuiPlatformImeData *) = 0;
+  // for viewports not drawn by a Renderer
+  virtual void render(void *) {}
 
 protected:
   Context *m_ctx;
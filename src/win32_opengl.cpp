@@ -17,7 +17,9 @@
 
 #include "opengl_renderer.hpp"
 
+#include "context.hpp"
 #include "error.hpp"
+#include "render_thread.hpp"
 #include "window.hpp"
 
 #define IMGL3W_IMPL
@@ -31,6 +33,8 @@ constexpr int WGL_CONTEXT_MAJOR_VERSION_ARB    { 0x2091 },
               WGL_CONTEXT_CORE_PROFILE_BIT_ARB { 0x0001 };
 typedef HGLRC (WINAPI *PFNWGLCREATECONTEXTATTRIBSARBPROC)
   (HDC hDC, HGLRC hShareContext, const int *attribList);
+typedef BOOL (WINAPI *PFNWGLSWAPINTERVALEXTPROC)(int interval);
+typedef int (WINAPI *PFNWGLGETSWAPINTERVALEXTPROC)();
 
 class Win32OpenGL final : public OpenGLRenderer {
 public:
@@ -44,9 +48,17 @@ public:
 private:
   void setPixelFormat();
   void createContext();
+  void setSwapInterval(int);
+  // waits for the render thread to release the GL context
+  void syncRenderThread() const;
 
   HDC m_dc;
   HGLRC m_gl;
+  int m_defaultInterval;
+  PFNWGLSWAPINTERVALEXTPROC m_wglSwapIntervalEXT;
+  std::shared_ptr<RenderThread> m_renderThread;
+  RenderThread::Ticket m_frame;
+  DrawDataSnapshot m_snapshot;
 };
 
 class MakeCurrent {
@@ -66,40 +78,69 @@ private:
   HGLRC m_gl;
 };
 
-struct GLDeleter {
-  void operator()(HGLRC gl)
-  {
-    wglDeleteContext(gl);
-  }
+// shared by the windows of every context
+struct SharedContext {
+  SharedContext(const HGLRC gl, const int defaultInterval)
+    : gl { gl }, defaultInterval { defaultInterval } {}
+  SharedContext(const SharedContext &) = delete;
+  ~SharedContext() { wglDeleteContext(gl); }
+
+  HGLRC gl;
+  int defaultInterval; // of the driver, before any window changed it
+  // current in the render thread while it runs the jobs of any window
+  std::weak_ptr<RenderThread> renderThread;
 };
 
 decltype(OpenGLRenderer::creator) OpenGLRenderer::creator
   { &Renderer::create<Win32OpenGL> };
 
 Win32OpenGL::Win32OpenGL(RendererFactory *factory, Window *window)
-  : OpenGLRenderer(factory, window), m_dc { GetDC(window->nativeHandle()) }
+  : OpenGLRenderer(factory, window), m_dc { GetDC(window->nativeHandle()) },
+    m_frame { 0 }
 {
   setPixelFormat();
 
-  if(m_shared->m_platform) {
-    using GL = std::remove_pointer_t<HGLRC>;
-    m_gl = std::static_pointer_cast<GL>(m_shared->m_platform).get();
+  std::shared_ptr<void> &platform { m_shared->m_group->m_platform };
+  if(platform) {
+    const auto context { std::static_pointer_cast<SharedContext>(platform) };
+    m_gl = context->gl;
+    m_defaultInterval = context->defaultInterval;
   }
   else {
     createContext();
-    m_shared->m_platform = { m_gl, GLDeleter{} };
+    platform = std::make_shared<SharedContext>(m_gl, m_defaultInterval);
   }
 
+  if(window->context()->IO().ConfigFlags & ReaImGuiConfigFlags_RenderThread) {
+    m_renderThread = RenderThread::get();
+    std::static_pointer_cast<SharedContext>(platform)->renderThread =
+      m_renderThread;
+  }
+
+  syncRenderThread();
   MakeCurrent cur { m_dc, m_gl };
   setup();
+
+  m_wglSwapIntervalEXT = reinterpret_cast<PFNWGLSWAPINTERVALEXTPROC>
+    (wglGetProcAddress("wglSwapIntervalEXT"));
 }
 
 Win32OpenGL::~Win32OpenGL()
 {
+  syncRenderThread(); // including the last frame of this window
   MakeCurrent cur { m_dc, m_gl };
   teardown();
 }
 
+void Win32OpenGL::syncRenderThread() const
+{
+  // a GL context can only be current in one thread at a time
+  const auto context
+    { std::static_pointer_cast<SharedContext>(m_shared->m_group->m_platform) };
+  if(const auto renderThread { context->renderThread.lock() })
+    renderThread->waitAll();
+}
+
 void Win32OpenGL::setPixelFormat()
 {
   constexpr PIXELFORMATDESCRIPTOR pfd {
@@ -142,16 +183,65 @@ void Win32OpenGL::createContext()
     wglDeleteContext(m_gl);
     throw backend_error { "OpenGL 3.2 is not available on this system" };
   }
+
+  // https://registry.khronos.org/OpenGL/extensions/EXT/WGL_EXT_swap_control.txt
+  PFNWGLGETSWAPINTERVALEXTPROC wglGetSwapIntervalEXT
+    { reinterpret_cast<PFNWGLGETSWAPINTERVALEXTPROC>
+      (wglGetProcAddress("wglGetSwapIntervalEXT")) };
+  m_defaultInterval = wglGetSwapIntervalEXT ? wglGetSwapIntervalEXT() : 1;
+}
+
+void Win32OpenGL::setSwapInterval(const int interval)
+{
+  // the GL context is shared by all windows, each may use a different interval
+  if(m_wglSwapIntervalEXT)
+    m_wglSwapIntervalEXT(interval < 0 ? m_defaultInterval : interval);
 }
 
 void Win32OpenGL::render(void *)
 {
-  MakeCurrent cur { m_dc, m_gl };
-  OpenGLRenderer::updateTextures();
-  OpenGLRenderer::render(false);
+  if(!m_renderThread) {
+    syncRenderThread(); // windows of other contexts may be using it
+    MakeCurrent cur { m_dc, m_gl };
+    setSwapInterval(swapInterval());
+    OpenGLRenderer::updateTextures();
+    OpenGLRenderer::render(false);
+    return;
+  }
+
+  // the snapshot and the draw batch are in use until the previous frame
+  // of this window is presented
+  m_renderThread->wait(m_frame);
+
+  // uploads read pixels owned by the main thread
+  if(hasTextureUpdates()) {
+    syncRenderThread();
+    MakeCurrent cur { m_dc, m_gl };
+    OpenGLRenderer::updateTextures();
+  }
+
+  const ImGuiViewport *viewport { m_window->viewport() };
+  m_snapshot.copy(viewport->DrawData);
+
+  const float scale { viewport->DpiScale };
+  const bool clear { !(viewport->Flags & ImGuiViewportFlags_NoRendererClear) };
+  const int interval { swapInterval() };
+  const DrawBatch *batch
+    { &batchDrawCalls(m_snapshot.get(), ImVec2(scale, scale)) };
+
+  m_frame = m_renderThread->push([this, batch, scale, clear, interval] {
+    MakeCurrent cur { m_dc, m_gl };
+    setSwapInterval(interval);
+    draw(m_snapshot.get(), *batch, scale, clear, false);
+    SwapBuffers(m_dc);
+  });
 }
 
 void Win32OpenGL::swapBuffers(void *)
 {
+  if(m_renderThread) // presented by the render thread along with the frame
+    return;
+
+  syncRenderThread();
   SwapBuffers(m_dc);
 }
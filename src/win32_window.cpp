@@ -199,6 +199,9 @@ void Win32Window::destroy()
   EnumThreadWindows(GetCurrentThreadId(),
     &reparentChildren, reinterpret_cast<LPARAM>(m_hwnd));
 
+  // the render thread may still be presenting into the window
+  m_renderer.reset();
+
   Window::destroy();
 }
 
@@ -24,6 +24,7 @@
 #include "platform.hpp"
 #include "renderer.hpp"
 
+#include <algorithm>
 #include <cassert>
 #include <imgui/imgui.h>
 #include <imgui/imgui_internal.h>
@@ -57,7 +58,8 @@ LRESULT CALLBACK Window::proc(HWND handle, const unsigned int msg,
   else {
     self = reinterpret_cast<Window *>(GetWindowLongPtr(handle, GWLP_USERDATA));
 
-    if(!self)
+    // m_viewport is null while waiting in a WindowPool
+    if(!self || (!self->m_viewport && msg != WM_DESTROY))
       return DefWindowProc(handle, msg, wParam, lParam);
   }
 
@@ -78,6 +80,15 @@ LRESULT CALLBACK Window::proc(HWND handle, const unsigned int msg,
   case WM_SIZE:
     self->m_viewport->PlatformRequestResize = true;
     return 0;
+  case WM_PAINT:
+    if(!self->m_renderer)
+      break;
+    else if(self->m_renderer->paint())
+      return 0;
+    // the exposed area is repainted by the next frame, even if unchanged
+    self->m_renderer->invalidate();
+    self->m_ctx->requestRedraw();
+    break;
   case WM_GETMINMAXINFO: {
     const ImVec2 minSize { self->m_ctx->style().WindowMinSize };
     MINMAXINFO *mmi { reinterpret_cast<MINMAXINFO *>(lParam) };
@@ -89,6 +100,8 @@ LRESULT CALLBACK Window::proc(HWND handle, const unsigned int msg,
     self->contextMenu(GET_X_LPARAM(lParam), GET_Y_LPARAM(lParam));
     break;
   case WM_DESTROY:
+    if(!self->m_viewport) // along with its owner while waiting in a WindowPool
+      self->m_hwnd = nullptr;
     RemoveProp(handle, CLASS_NAME);
     // Disable message passing to the derived class (not available at this point)
     SetWindowLongPtr(handle, GWLP_USERDATA, 0);
@@ -160,11 +173,7 @@ Window::Window(ImGuiViewport *viewport, DockerHost *dockerHost)
   else
     m_hwndInfo = g_hwndInfo.lock();
 
-  // HACK: See Window::show. Not using ViewportFlags because it would always be
-  // set when using BeginPopup.
-  ImGuiViewportP *viewportPrivate { static_cast<ImGuiViewportP *>(viewport) };
-  if(ImGuiWindow *userWindow { viewportPrivate->Window })
-    m_noFocus = userWindow->Flags & ImGuiWindowFlags_NoFocusOnAppearing;
+  updateNoFocus();
 
   // Cannot initialize m_hwnd during construction due to handleMessage being
   // virtual. This task is delayed to created() called once fully constructed.
@@ -181,6 +190,45 @@ void Window::destroy()
   m_hwnd = nullptr;
 }
 
+void Window::release()
+{
+  releaseMouse();
+  hide();
+
+  m_viewport->RendererUserData = nullptr;
+  m_viewport = nullptr; // about to be destroyed by dear imgui
+}
+
+void Window::reuse(ImGuiViewport *viewport)
+{
+  m_viewport = viewport;
+  updateNoFocus();
+#ifdef _WIN32
+  // keep above the new parent viewport
+  SetWindowLongPtr(m_hwnd, GWLP_HWNDPARENT,
+    reinterpret_cast<LONG_PTR>(parentHandle()));
+#endif
+
+  if(m_renderer)
+    m_renderer->rebind();
+}
+
+void Window::hide()
+{
+  ShowWindow(m_hwnd, SW_HIDE);
+}
+
+void Window::updateNoFocus()
+{
+  // HACK: See Window::show. Not using ViewportFlags because it would always be
+  // set when using BeginPopup.
+  ImGuiViewportP *viewportPrivate { static_cast<ImGuiViewportP *>(m_viewport) };
+  if(ImGuiWindow *userWindow { viewportPrivate->Window })
+    m_noFocus = userWindow->Flags & ImGuiWindowFlags_NoFocusOnAppearing;
+  else
+    m_noFocus = false;
+}
+
 void Window::show()
 {
   if(isDocked())
@@ -434,3 +482,57 @@ void Window::contextMenu(const short x, const short y)
     break;
   }
 }
+
+WindowPool::~WindowPool()
+{
+  for(const Entry &entry : m_entries) {
+    if(entry.window->nativeHandle())
+      entry.window->destroy();
+  }
+}
+
+void WindowPool::purge()
+{
+  const auto &dead { [](const Entry &entry) {
+    return !entry.window->nativeHandle();
+  }};
+  m_entries.erase(std::remove_if(m_entries.begin(), m_entries.end(), dead),
+    m_entries.end());
+}
+
+Window *WindowPool::take(ImGuiViewport *viewport)
+{
+  purge();
+
+  // most recently released first
+  for(auto it { m_entries.rbegin() }; it != m_entries.rend(); ++it) {
+    if(it->flags != viewport->Flags)
+      continue;
+
+    Window *window { it->window.release() };
+    m_entries.erase(std::next(it).base());
+    window->reuse(viewport);
+    return window;
+  }
+
+  return nullptr;
+}
+
+bool WindowPool::give(Viewport *instance)
+{
+  Window *window { dynamic_cast<Window *>(instance) };
+  if(!window || window->isDocked() ||
+      !(instance->viewport()->Flags & ImGuiViewportFlags_NoTaskBarIcon))
+    return false;
+
+  purge();
+  if(m_entries.size() >= MAX_SIZE) {
+    m_entries.front().window->destroy();
+    m_entries.erase(m_entries.begin());
+  }
+
+  const ImGuiViewportFlags flags { instance->viewport()->Flags };
+  window->release();
+  m_entries.push_back({ flags, std::unique_ptr<Window> { window } });
+  return true;
+}
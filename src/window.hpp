@@ -24,10 +24,12 @@
 
 #include <memory>
 #include <optional>
+#include <vector>
 
 class DockerHost;
 class Renderer;
 typedef int ImGuiMouseButton;
+typedef int ImGuiViewportFlags;
 
 class Window : public Viewport {
 public:
@@ -61,6 +63,10 @@ public:
   void releaseMouse();
   bool isDocked() const { return !!m_dockerHost; }
 
+  // hides the window (keeping its renderer) until reused by another viewport
+  void release();
+  void reuse(ImGuiViewport *);
+
   const char *getSwellClass() const;
 
 protected:
@@ -69,6 +75,7 @@ protected:
 
   void createSwellDialog();
   HWND parentHandle();
+  virtual void hide();
 
   virtual std::optional<LRESULT> handleMessage(unsigned int msg, WPARAM, LPARAM) = 0;
   virtual int handleAccelerator(MSG *);
@@ -80,6 +87,7 @@ private:
   static int hwndInfo(HWND, INT_PTR type);
   static int translateAccel(MSG *msg, accelerator_register_t *accel);
   void updateModifiers();
+  void updateNoFocus();
   void transferCapture();
   void contextMenu(short x, short y);
 
@@ -93,4 +101,28 @@ private:
   bool m_noFocus;
 };
 
+// Windows of short-lived viewports (tooltips, popups, menus...) are kept
+// hidden after destruction for reuse by the next one having the same flags.
+// This saves creating a native window and a renderer (and uploading all
+// textures again when they cannot be shared) every time.
+class WindowPool {
+public:
+  static constexpr size_t MAX_SIZE { 4 };
+
+  ~WindowPool();
+
+  Window *take(ImGuiViewport *); // nullptr if none are available
+  bool give(Viewport *);         // false if not poolable
+
+private:
+  struct Entry {
+    ImGuiViewportFlags flags;
+    std::unique_ptr<Window> window;
+  };
+
+  void purge(); // windows destroyed along with their owner
+
+  std::vector<Entry> m_entries;
+};
+
 #endif
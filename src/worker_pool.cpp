@@ -0,0 +1,29 @@
+/* ReaImGui: ReaScript binding for Dear ImGui
+ * Copyright (C) 2021-2024  Christian Fillion
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "worker_pool.hpp"
+
+void WorkerPool::run(const std::vector<Job> &jobs)
+{
+  JobQueue::Ticket last {};
+  for(const Job &job : jobs) // the vector outlives the jobs
+    last = m_queue.push([&job] { job(); });
+
+  while(m_queue.runOne());
+  m_queue.wait(last);
+}
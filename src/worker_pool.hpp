@@ -0,0 +1,40 @@
+/* ReaImGui: ReaScript binding for Dear ImGui
+ * Copyright (C) 2021-2024  Christian Fillion
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef REAIMGUI_WORKER_POOL_HPP
+#define REAIMGUI_WORKER_POOL_HPP
+
+#include "job_queue.hpp"
+
+// Runs batches of independent jobs concurrently on background threads
+class WorkerPool {
+public:
+  using Job = JobQueue::Job;
+
+  WorkerPool(unsigned int threads) : m_queue { threads } {}
+
+  // blocks until every job has returned, jobs must not throw
+  // the calling thread executes jobs as well
+  void run(const std::vector<Job> &);
+  size_t size() const { return m_queue.size(); }
+
+private:
+  JobQueue m_queue;
+};
+
+#endif
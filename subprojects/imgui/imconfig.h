@@ -6,6 +6,12 @@ namespace Error {
   [[noreturn]] void imguiDebugBreak();
 };
 
+// the current context is per-thread for Context::renderFrames to call
+// ImGui::Render concurrently for multiple contexts
+struct ImGuiContext;
+inline thread_local ImGuiContext *ReaImGuiCurrentContext {};
+#define GImGui ReaImGuiCurrentContext
+
 #define IMGUI_DISABLE_OBSOLETE_FUNCTIONS
 #define IMGUI_DISABLE_WIN32_DEFAULT_IME_FUNCTIONS
 #define IMGUI_ENABLE_FREETYPE
@@ -0,0 +1,75 @@
+#include "../src/decoder_pool.hpp"
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <future>
+
+TEST(DecoderPoolTest, RunAll) {
+  std::atomic<int> count { 0 };
+  std::promise<void> done;
+  DecoderPool pool { 3 }; // destroyed first
+
+  constexpr int JOBS { 100 };
+  for(int i {}; i < JOBS; ++i) {
+    pool.push([&] {
+      if(++count == JOBS)
+        done.set_value();
+    });
+  }
+
+  done.get_future().wait();
+  EXPECT_EQ(count, JOBS);
+}
+
+TEST(DecoderPoolTest, Concurrent) {
+  std::promise<void> first, second;
+  std::shared_future<void> firstStarted { first.get_future() },
+                           secondDone   { second.get_future() };
+  DecoderPool pool { 2 };
+
+  // each job waits for the other, deadlocking if they run sequentially
+  pool.push([&] {
+    first.set_value();
+    secondDone.wait();
+  });
+  pool.push([&] {
+    firstStarted.wait();
+    second.set_value();
+  });
+
+  secondDone.wait();
+}
+
+TEST(DecoderPoolTest, DiscardPending) {
+  std::atomic<int> count { 0 };
+  std::promise<void> release;
+  std::thread releaser;
+
+  {
+    DecoderPool pool { 1 };
+    std::promise<void> started;
+    pool.push([&, released = release.get_future().share()] {
+      started.set_value();
+      released.wait();
+      ++count;
+    });
+    pool.push([&] { ++count; });
+    started.get_future().wait();
+
+    releaser = std::thread { [&] {
+      std::this_thread::sleep_for(std::chrono::milliseconds { 10 });
+      release.set_value();
+    }};
+  }
+  releaser.join();
+
+  EXPECT_EQ(count, 1); // the running job completed, the queued one was dropped
+}
+
+TEST(DecoderPoolTest, Shared) {
+  DecoderPool &a { DecoderPool::get() }, &b { DecoderPool::get() };
+  EXPECT_EQ(&a, &b);
+  EXPECT_GE(a.size(), 1u);
+  DecoderPool::teardown();
+}
@@ -0,0 +1,38 @@
+#include "../src/frame_timings.hpp"
+
+#include <gtest/gtest.h>
+
+TEST(TimingHistoryTest, Empty) {
+  const TimingHistory history;
+  EXPECT_EQ(history.count(), 0u);
+
+  const TimingHistory::Stats stats { history.stats() };
+  EXPECT_EQ(stats.min, 0.0);
+  EXPECT_EQ(stats.avg, 0.0);
+  EXPECT_EQ(stats.p99, 0.0);
+}
+
+TEST(TimingHistoryTest, Stats) {
+  TimingHistory history;
+  for(int i { 1 }; i <= 100; ++i)
+    history.add(i / 1000.0);
+  EXPECT_EQ(history.count(), 100u);
+
+  const TimingHistory::Stats stats { history.stats() };
+  EXPECT_FLOAT_EQ(stats.min, 0.001);
+  EXPECT_FLOAT_EQ(stats.avg, 0.0505);
+  EXPECT_FLOAT_EQ(stats.p99, 0.099);
+}
+
+TEST(TimingHistoryTest, Rolling) {
+  TimingHistory history;
+  history.add(1.0); // a slow frame is forgotten after SIZE more frames
+  for(size_t i {}; i < TimingHistory::SIZE; ++i)
+    history.add(0.01);
+  EXPECT_EQ(history.count(), TimingHistory::SIZE);
+
+  const TimingHistory::Stats stats { history.stats() };
+  EXPECT_FLOAT_EQ(stats.min, 0.01);
+  EXPECT_FLOAT_EQ(stats.avg, 0.01);
+  EXPECT_FLOAT_EQ(stats.p99, 0.01);
+}
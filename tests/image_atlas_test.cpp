@@ -0,0 +1,209 @@
+#include "../src/image_atlas.hpp"
+
+#include "../src/image.hpp"
+#include "../src/texture.hpp"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <imgui/imgui_internal.h>
+#include <memory>
+
+class TestImage : public Bitmap {
+public:
+  TestImage(const int width, const int height) { resize(width, height, 4); }
+};
+
+static std::unique_ptr<ImGuiContext, decltype(&ImGui::DestroyContext)> makeContext()
+{
+  return { ImGui::CreateContext(), &ImGui::DestroyContext };
+}
+
+TEST(ImageAtlasTest, DrawCallCount) {
+  const auto ctx { makeContext() };
+
+  constexpr int ICON_COUNT { 200 }, ICON_SIZE { 16 };
+
+  TextureManager manager;
+  ImageAtlas     atlas { &manager };
+  std::vector<std::unique_ptr<TestImage>> icons;
+  for(int i {}; i < ICON_COUNT; ++i)
+    icons.push_back(std::make_unique<TestImage>(ICON_SIZE, ICON_SIZE));
+
+  // a toolbar of icons, as drawn by Image or DrawList_AddImage
+  const auto countDrawCalls { [&](const bool useAtlas) {
+    ImDrawList drawList { ImGui::GetDrawListSharedData() };
+    drawList._ResetForNewFrame();
+    drawList.PushClipRectFullScreen();
+
+    for(int i {}; i < ICON_COUNT; ++i) {
+      TestImage *icon { icons[i].get() };
+      ImVec2 uv[] { ImVec2(0.f, 0.f), ImVec2(1.f, 1.f) };
+      const ImTextureID tex { useAtlas ? *atlas.makeTexture(icon, uv, 2)
+                                       : manager.touch(icon, 1.f, nullptr) };
+      drawList.AddImage(tex, ImVec2(i * ICON_SIZE, 0),
+        ImVec2((i + 1) * ICON_SIZE, ICON_SIZE), uv[0], uv[1]);
+    }
+
+    drawList._PopUnusedDrawCmd();
+    return drawList.CmdBuffer.Size;
+  }};
+
+  const int separate { countDrawCalls(false) }, atlased { countDrawCalls(true) };
+  RecordProperty("DrawCallsWithoutAtlas", separate);
+  RecordProperty("DrawCallsWithAtlas",    atlased);
+  EXPECT_EQ(separate, ICON_COUNT);
+  EXPECT_EQ(atlased,  1);
+}
+
+TEST(ImageAtlasTest, RemapUV) {
+  const auto ctx { makeContext() };
+
+  TextureManager manager;
+  ImageAtlas     atlas { &manager };
+  TestImage      a { 32, 16 }, b { 32, 16 };
+
+  ImVec2 uvA[] { ImVec2(0.f, 0.f), ImVec2(1.f, 1.f) },
+         uvB[] { ImVec2(0.f, 0.f), ImVec2(0.5f, 1.f) };
+  const auto texA { atlas.makeTexture(&a, uvA, 2) },
+             texB { atlas.makeTexture(&b, uvB, 2) };
+  ASSERT_TRUE(texA && texB);
+  EXPECT_EQ(*texA, *texB);
+
+  constexpr float PAGE_SIZE { ImageAtlas::PAGE_SIZE };
+  // images are surrounded by a 1px border
+  EXPECT_EQ(uvA[0].x, 1.f  / PAGE_SIZE);
+  EXPECT_EQ(uvA[0].y, 1.f  / PAGE_SIZE);
+  EXPECT_EQ(uvA[1].x, 33.f / PAGE_SIZE);
+  EXPECT_EQ(uvA[1].y, 17.f / PAGE_SIZE);
+  EXPECT_EQ(uvB[0].x, 35.f / PAGE_SIZE);
+  EXPECT_EQ(uvB[0].y, 1.f  / PAGE_SIZE);
+  EXPECT_EQ(uvB[1].x, 51.f / PAGE_SIZE);
+  EXPECT_EQ(uvB[1].y, 17.f / PAGE_SIZE);
+}
+
+TEST(ImageAtlasTest, Fallback) {
+  const auto ctx { makeContext() };
+
+  TextureManager manager;
+  ImageAtlas     atlas { &manager };
+  TestImage      large { ImageAtlas::MAX_IMAGE_SIZE + 1, 16 }, small { 16, 16 };
+
+  ImVec2 uv[] { ImVec2(0.f, 0.f), ImVec2(1.f, 1.f) };
+  EXPECT_FALSE(atlas.makeTexture(&large, uv, 2));
+
+  ImVec2 tiled[] { ImVec2(0.f, 0.f), ImVec2(2.f, 2.f) };
+  EXPECT_FALSE(atlas.makeTexture(&small, tiled, 2));
+  EXPECT_EQ(tiled[1].x, 2.f); // untouched
+}
+
+TEST(ImageAtlasTest, Cleanup) {
+  const auto ctx { makeContext() };
+  const ImGuiIO &io { ImGui::GetIO() };
+
+  TextureManager manager;
+  ImageAtlas     atlas { &manager };
+  auto image { std::make_unique<TestImage>(16, 16) };
+
+  ImVec2 uv[] { ImVec2(0.f, 0.f), ImVec2(1.f, 1.f) };
+  const auto page { atlas.makeTexture(image.get(), uv, 2) };
+  ASSERT_TRUE(page);
+
+  atlas.cleanup();
+  EXPECT_EQ(manager.stats().textures, 1u);
+
+  ctx->Time += io.ConfigMemoryCompactTimer;
+  atlas.cleanup();
+  EXPECT_EQ(manager.stats().textures, 0u); // empty page is freed
+}
+
+TEST(ImageAtlasTest, Update) {
+  const auto ctx { makeContext() };
+
+  TextureManager manager;
+  ImageAtlas     atlas { &manager };
+  PixelImage     image { 16, 16 };
+
+  ImVec2 uv[] { ImVec2(0.f, 0.f), ImVec2(1.f, 1.f) };
+  const auto page { atlas.makeTexture(&image, uv, 2) };
+  ASSERT_TRUE(page);
+
+  constexpr unsigned char red[] { 0xFF, 0x00, 0x00, 0xFF };
+  image.update(0, 0, 1, 1, red);
+  const TextureVersion version { manager.version() };
+  atlas.update(&image);
+  EXPECT_NE(manager.version(), version);
+
+  int width, height;
+  const unsigned char *pixels { manager.get(*page).getPixels(&width, &height) };
+  for(const int i : { 0, 1, width, width + 1 }) // including the border
+    EXPECT_TRUE(std::equal(std::begin(red), std::end(red), &pixels[i * 4])) << i;
+  EXPECT_EQ(pixels[(width + 2) * 4], 0x00);
+}
+
+TEST(ImageAtlasTest, ReusedAddress) {
+  const auto ctx { makeContext() };
+
+  TextureManager manager;
+  ImageAtlas     atlas { &manager };
+  alignas(TestImage) unsigned char storage[sizeof(TestImage)];
+
+  ImVec2 uvA[] { ImVec2(0.f, 0.f), ImVec2(1.f, 1.f) },
+         uvB[] { ImVec2(0.f, 0.f), ImVec2(1.f, 1.f) };
+  TestImage *image { new (storage) TestImage { 16, 16 } };
+  ASSERT_TRUE(atlas.makeTexture(image, uvA, 2));
+  image->~TestImage();
+
+  // a new image allocated at the address of the freed one
+  image = new (storage) TestImage { 32, 16 };
+  ASSERT_TRUE(atlas.makeTexture(image, uvB, 2));
+  image->~TestImage();
+
+  constexpr float PAGE_SIZE { ImageAtlas::PAGE_SIZE };
+  EXPECT_EQ(uvB[0].x, 19.f / PAGE_SIZE); // placed after the first image
+  EXPECT_EQ(uvB[1].x, 51.f / PAGE_SIZE);
+}
+
+TEST(ImageAtlasTest, CleanupDestroyed) {
+  const auto ctx { makeContext() };
+
+  TextureManager manager;
+  ImageAtlas     atlas { &manager };
+  auto image { std::make_unique<TestImage>(16, 16) };
+
+  ImVec2 uv[] { ImVec2(0.f, 0.f), ImVec2(1.f, 1.f) };
+  ASSERT_TRUE(atlas.makeTexture(image.get(), uv, 2));
+
+  image.reset();
+  atlas.cleanup();
+  EXPECT_EQ(manager.stats().textures, 0u);
+}
+
+TEST(ImageAtlasTest, KeepShelfAfterFailedFit) {
+  const auto ctx { makeContext() };
+
+  constexpr int SIZE { ImageAtlas::MAX_IMAGE_SIZE }, SLOT { SIZE + 2 },
+                PER_ROW { ImageAtlas::PAGE_SIZE / SLOT };
+
+  TextureManager manager;
+  ImageAtlas     atlas { &manager };
+  std::vector<std::unique_ptr<TestImage>> images;
+  ImVec2 uv[2];
+  const auto place { [&](const int width, const int height) {
+    images.push_back(std::make_unique<TestImage>(width, height));
+    uv[0] = ImVec2(0.f, 0.f), uv[1] = ImVec2(1.f, 1.f);
+    return atlas.makeTexture(images.back().get(), uv, 2);
+  }};
+
+  // fill the first page until a large image no longer fits
+  std::optional<size_t> firstPage;
+  for(int i {}; i < PER_ROW * PER_ROW; ++i)
+    firstPage = place(SIZE, SIZE);
+  EXPECT_NE(place(SIZE, SIZE), firstPage);
+
+  // a small image still fits at the end of the last shelf of the first page
+  EXPECT_EQ(place(16, 16), firstPage);
+  constexpr float PAGE_SIZE { ImageAtlas::PAGE_SIZE };
+  EXPECT_EQ(uv[0].x, ((PER_ROW * SLOT) + 1) / PAGE_SIZE);
+  EXPECT_EQ(uv[0].y, (((PER_ROW - 1) * SLOT) + 1) / PAGE_SIZE);
+}
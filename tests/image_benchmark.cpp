@@ -0,0 +1,96 @@
+#include "../src/image.hpp"
+
+#include "../src/error.hpp"
+#include "image_samples.hpp"
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <cstdlib>
+#include <memory>
+
+using Decoder = BitmapData (*)(const std::filesystem::path &);
+
+static BitmapData decodeStream(const std::filesystem::path &path)
+{
+  std::ifstream file { path, std::ios_base::binary };
+  return BitmapData::fromStream(file);
+}
+
+static BitmapData decodeMapped(const std::filesystem::path &path)
+{
+  return BitmapData::fromFile(path.string().c_str());
+}
+
+struct Throughput {
+  size_t pixels;
+  std::chrono::duration<double> elapsed;
+
+  void measure(const std::vector<std::filesystem::path> &corpus, Decoder);
+  double megapixelsPerSecond() const { return pixels / elapsed.count() / 1e6; }
+};
+
+void Throughput::measure(const std::vector<std::filesystem::path> &corpus,
+  const Decoder decode)
+{
+  using Clock = std::chrono::steady_clock;
+  const auto start { Clock::now() };
+  for(const auto &path : corpus) {
+    try {
+      const BitmapData bitmap { decode(path) };
+      pixels += bitmap.width() * bitmap.height();
+    }
+    catch(const reascript_error &) {} // unsupported file in the corpus
+  }
+  elapsed += Clock::now() - start;
+}
+
+// Set REAIMGUI_IMAGE_CORPUS to a directory of PNG and JPEG files
+// to measure the decoding speed of real-world images
+TEST(BitmapDataBenchmark, DecodeThroughput) {
+  constexpr int ROUNDS { 4 };
+
+  std::vector<std::unique_ptr<TempFile>> generated;
+  std::vector<std::filesystem::path> corpus;
+
+  if(const char *dir { getenv("REAIMGUI_IMAGE_CORPUS") }) {
+    for(const auto &entry : std::filesystem::directory_iterator { dir }) {
+      if(entry.is_regular_file())
+        corpus.push_back(entry.path());
+    }
+  }
+  else {
+    for(int i {}; i < 8; ++i) {
+      const auto &encode { i & 1 ? &encodeJPEG : &encodePNG };
+      generated.push_back(
+        std::make_unique<TempFile>("reaimgui_corpus", encode(512, 512)));
+      corpus.push_back(generated.back()->path());
+    }
+  }
+
+  // load the files in the page cache before timing either path
+  Throughput warmUp {};
+  warmUp.measure(corpus, &decodeStream);
+  if(!warmUp.pixels)
+    GTEST_SKIP() << "no supported image in the corpus";
+
+  // alternated for neither path to always run first
+  Throughput stream {}, mapped {};
+  for(int i {}; i < ROUNDS; ++i) {
+    if(i & 1) {
+      mapped.measure(corpus, &decodeMapped);
+      stream.measure(corpus, &decodeStream);
+    }
+    else {
+      stream.measure(corpus, &decodeStream);
+      mapped.measure(corpus, &decodeMapped);
+    }
+  }
+
+  RecordProperty("CorpusFiles", static_cast<int>(corpus.size()));
+  RecordProperty("StreamMegapixelsPerSecond",
+    std::to_string(stream.megapixelsPerSecond()));
+  RecordProperty("MappedMegapixelsPerSecond",
+    std::to_string(mapped.megapixelsPerSecond()));
+  EXPECT_EQ(mapped.pixels, stream.pixels);
+}
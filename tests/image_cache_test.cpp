@@ -0,0 +1,101 @@
+#include "../src/image_cache.hpp"
+
+#include "../src/error.hpp"
+
+#include <gtest/gtest.h>
+
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+
+static void writeImage(const std::filesystem::path &path,
+  const int width, const int height)
+{
+  const std::vector<unsigned char> rgba(static_cast<size_t>(width) * height * 4);
+  std::ostringstream png;
+  writePNG(png, rgba.data(), width, height);
+  std::ofstream { path, std::ios_base::binary | std::ios_base::trunc } << png.str();
+}
+
+class ImageCacheTest : public testing::Test {
+protected:
+  ImageCacheTest()
+    : m_path { std::filesystem::temp_directory_path() / "reaimgui_cache_test" }
+  {
+    writeImage(m_path, 16, 16);
+  }
+  ~ImageCacheTest() { std::filesystem::remove(m_path); }
+
+  const char *path() const { return m_pathString.c_str(); }
+
+  std::filesystem::path m_path;
+  std::string m_pathString { m_path.string() };
+};
+
+class TestImage : public Bitmap {
+public:
+  using Bitmap::Bitmap;
+  using Bitmap::resize;
+};
+
+TEST_F(ImageCacheTest, Hit) {
+  ImageCache cache;
+  const ImageCache::Data first { cache.load(path()) }, second { cache.load(path()) };
+  EXPECT_EQ(first, second);
+  EXPECT_EQ(first->width(), 16u);
+
+  const ImageCache::Stats stats { cache.stats() };
+  EXPECT_EQ(stats.hits,   1u);
+  EXPECT_EQ(stats.misses, 1u);
+  EXPECT_EQ(stats.images, 1u);
+  EXPECT_EQ(stats.bytes,  16u * 16 * 4);
+}
+
+TEST_F(ImageCacheTest, Modified) {
+  ImageCache cache;
+  const ImageCache::Data before { cache.load(path()) };
+  writeImage(m_path, 32, 16); // changes the file size
+  const ImageCache::Data after { cache.load(path()) };
+  EXPECT_NE(before, after);
+  EXPECT_EQ(after->width(), 32u);
+  EXPECT_EQ(cache.stats().misses, 2u);
+  EXPECT_EQ(cache.stats().images, 1u);
+}
+
+TEST_F(ImageCacheTest, MaxSize) {
+  ImageCache cache;
+  const ImageCache::Data full { cache.load(path()) },
+                      shrunk { cache.load(path(), { 8, 8 }) };
+  EXPECT_NE(full, shrunk);
+  EXPECT_EQ(shrunk->width(), 8u);
+  EXPECT_EQ(cache.stats().images, 2u);
+}
+
+TEST_F(ImageCacheTest, Evict) {
+  ImageCache cache { 16 * 16 * 4 };
+  const ImageCache::Data full { cache.load(path()) };
+  cache.load(path(), { 8, 8 }); // evicts the least recently used
+  EXPECT_EQ(cache.stats().images, 1u);
+  EXPECT_EQ(cache.stats().bytes,  8u * 8 * 4);
+  EXPECT_EQ(full->width(), 16u); // still owned by the caller
+
+  EXPECT_NE(cache.load(path()), full);
+  EXPECT_EQ(cache.stats().misses, 3u);
+}
+
+TEST_F(ImageCacheTest, MissingFile) {
+  ImageCache cache;
+  EXPECT_THROW(cache.load("/reaimgui/nonexistent.png"), reascript_error);
+  EXPECT_EQ(cache.stats().images, 0u);
+}
+
+TEST_F(ImageCacheTest, CopyOnWrite) {
+  ImageCache cache;
+  TestImage a { cache.load(path()) }, b { cache.load(path()) };
+  EXPECT_EQ(a.pixels(), b.pixels());
+
+  a.resize(4, 4, 4);
+  EXPECT_EQ(a.width(), 4u);
+  EXPECT_EQ(b.width(), 16u);
+  EXPECT_EQ(cache.load(path())->width(), 16u);
+}
@@ -0,0 +1,81 @@
+#ifndef REAIMGUI_TESTS_IMAGE_SAMPLES_HPP
+#define REAIMGUI_TESTS_IMAGE_SAMPLES_HPP
+
+#include "../src/image.hpp"
+
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <jpeglib.h>
+#include <random>
+#include <sstream>
+
+// a gradient, not compressing too well
+inline std::vector<unsigned char> makePixels(const int width, const int height)
+{
+  std::vector<unsigned char> rgba(static_cast<size_t>(width) * height * 4);
+  for(int y {}; y < height; ++y) {
+    for(int x {}; x < width; ++x) {
+      unsigned char *pixel { &rgba[((y * width) + x) * 4] };
+      pixel[0] = x, pixel[1] = y, pixel[2] = x ^ y, pixel[3] = 0xFF;
+    }
+  }
+  return rgba;
+}
+
+inline std::string encodePNG(const int width, const int height)
+{
+  std::ostringstream stream;
+  writePNG(stream, makePixels(width, height).data(), width, height);
+  return stream.str();
+}
+
+inline std::string encodeJPEG(const int width, const int height)
+{
+  jpeg_compress_struct jpeg;
+  jpeg_error_mgr err;
+  jpeg.err = jpeg_std_error(&err);
+  jpeg_create_compress(&jpeg);
+
+  unsigned char *buffer {};
+  unsigned long size {};
+  jpeg_mem_dest(&jpeg, &buffer, &size);
+  jpeg.image_width      = width;
+  jpeg.image_height     = height;
+  jpeg.input_components = 4;
+  jpeg.in_color_space   = JCS_EXT_RGBA;
+  jpeg_set_defaults(&jpeg);
+  jpeg_start_compress(&jpeg, TRUE);
+
+  std::vector<unsigned char> rgba { makePixels(width, height) };
+  while(jpeg.next_scanline < jpeg.image_height) {
+    JSAMPROW row { &rgba[jpeg.next_scanline * width * 4] };
+    jpeg_write_scanlines(&jpeg, &row, 1);
+  }
+
+  jpeg_finish_compress(&jpeg);
+  jpeg_destroy_compress(&jpeg);
+
+  std::string data(reinterpret_cast<char *>(buffer), size);
+  free(buffer);
+  return data;
+}
+
+// uniquely named for test programs running in parallel
+class TempFile {
+public:
+  TempFile(const std::string &prefix, const std::string &data)
+    : m_path { std::filesystem::temp_directory_path() /
+        (prefix + '_' + std::to_string(std::random_device {}())) }
+  {
+    std::ofstream { m_path, std::ios_base::binary } << data;
+  }
+  ~TempFile() { std::filesystem::remove(m_path); }
+
+  const std::filesystem::path &path() const { return m_path; }
+
+private:
+  std::filesystem::path m_path;
+};
+
+#endif
@@ -0,0 +1,153 @@
+#include "../src/image.hpp"
+
+#include "../src/error.hpp"
+#include "image_samples.hpp"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <sstream>
+
+static bool operator==(const BitmapData &a, const BitmapData &b)
+{
+  return a.width() == b.width() && a.height() == b.height() &&
+    std::equal(a.pixels(), a.pixels() + (a.width() * a.height() * 4), b.pixels());
+}
+
+class BitmapDataTest : public testing::TestWithParam<std::string (*)(int, int)> {};
+
+TEST_P(BitmapDataTest, SameAsStream) {
+  const std::string data { GetParam()(67, 33) };
+  const TempFile file { "reaimgui_image_test", data };
+
+  std::istringstream stream { data };
+  const BitmapData expected { BitmapData::fromStream(stream) };
+  ASSERT_EQ(expected.width(),  67u);
+  ASSERT_EQ(expected.height(), 33u);
+
+  EXPECT_TRUE(BitmapData::fromMemory(data.data(), data.size()) == expected);
+  EXPECT_TRUE(BitmapData::fromFile(file.path().string().c_str()) == expected);
+}
+
+TEST_P(BitmapDataTest, Truncated) {
+  const std::string data { GetParam()(64, 64) };
+  EXPECT_THROW(BitmapData::fromMemory(data.data(), data.size() / 2),
+    reascript_error);
+}
+
+INSTANTIATE_TEST_SUITE_P(Formats, BitmapDataTest,
+  testing::Values(&encodePNG, &encodeJPEG));
+
+TEST(BitmapDataTest, FileErrors) {
+  EXPECT_THROW(BitmapData::fromFile("/reaimgui/nonexistent.png"), reascript_error);
+
+  const TempFile empty { "reaimgui_image_empty", {} };
+  EXPECT_THROW(BitmapData::fromFile(empty.path().string().c_str()),
+    reascript_error);
+}
+
+TEST_P(BitmapDataTest, MaxSize) {
+  const std::string data { GetParam()(67, 33) };
+  const BitmapData bitmap { BitmapData::fromMemory(data.data(), data.size(),
+                                                   { 32, 32 }) };
+  EXPECT_EQ(bitmap.width(),  32u);
+  EXPECT_EQ(bitmap.height(), 16u);
+
+  const BitmapData large { BitmapData::fromMemory(data.data(), data.size(),
+                                                  { 100, 0 }) };
+  EXPECT_EQ(large.width(),  67u); // never enlarged
+  EXPECT_EQ(large.height(), 33u);
+}
+
+TEST_P(BitmapDataTest, LargerThanTextures) {
+  const std::string data { GetParam()(0x2001, 2) };
+  EXPECT_THROW(BitmapData::fromMemory(data.data(), data.size()),
+    reascript_error);
+
+  const BitmapData bitmap { BitmapData::fromMemory(data.data(), data.size(),
+                                                   { 0x1000, 0 }) };
+  EXPECT_EQ(bitmap.width(),  0x1000u);
+  EXPECT_EQ(bitmap.height(), 1u);
+}
+
+TEST(BitmapDataTest, ScaledJPEG) {
+  const std::string data { encodeJPEG(512, 512) };
+  std::istringstream stream { data };
+  const BitmapData bitmap { BitmapData::fromStream(stream, { 128, 0 }) };
+  EXPECT_EQ(bitmap.width(),  128u);
+  EXPECT_EQ(bitmap.height(), 128u);
+}
+
+TEST(BitmapDataTest, ShrinkWeightsAlpha) {
+  BitmapData bitmap;
+  bitmap.resize(2, 1, 4);
+  unsigned char *pixels { bitmap.makeScanlines()[0] };
+  constexpr unsigned char transparentRed[] { 0xFF, 0x00, 0x00, 0x00 },
+                          opaqueBlue[]     { 0x00, 0x00, 0xFF, 0xFF };
+  std::copy(std::begin(transparentRed), std::end(transparentRed), pixels);
+  std::copy(std::begin(opaqueBlue),     std::end(opaqueBlue),     pixels + 4);
+
+  bitmap.shrink({ 1, 1 });
+  ASSERT_EQ(bitmap.width(),  1u);
+  ASSERT_EQ(bitmap.height(), 1u);
+  // invisible pixels must not bleed their color
+  EXPECT_EQ(bitmap.pixels()[0], 0x00);
+  EXPECT_EQ(bitmap.pixels()[1], 0x00);
+  EXPECT_EQ(bitmap.pixels()[2], 0xFF);
+  EXPECT_EQ(bitmap.pixels()[3], 0x80);
+}
+
+TEST(PixelImageTest, Update) {
+  PixelImage image { 3, 2 };
+  const unsigned char *pixels { image.pixels() };
+  EXPECT_TRUE(std::all_of(pixels, pixels + (3 * 2 * 4),
+    [](const unsigned char c) { return c == 0; }));
+
+  constexpr unsigned char rgba[] { 1, 2, 3, 4,  5, 6, 7, 8 };
+  image.update(1, 1, 2, 1, rgba);
+  EXPECT_TRUE(std::equal(std::begin(rgba), std::end(rgba), &pixels[(3 + 1) * 4]));
+  EXPECT_EQ(pixels[3 * 4], 0); // left of the region
+
+  // packed colors, also accepting negative signed integers
+  constexpr double colors[] { 0x11223344, -1 };
+  image.update(0, 0, 1, 2, colors);
+  EXPECT_EQ(pixels[0], 0x11);
+  EXPECT_EQ(pixels[1], 0x22);
+  EXPECT_EQ(pixels[2], 0x33);
+  EXPECT_EQ(pixels[3], 0x44);
+  EXPECT_EQ(pixels[(3 * 4) + 0], 0xFF);
+  EXPECT_EQ(pixels[(3 * 4) + 3], 0xFF);
+}
+
+TEST(PixelImageTest, OutOfBounds) {
+  EXPECT_THROW((PixelImage { 0, 1 }), reascript_error);
+
+  PixelImage image { 2, 2 };
+  constexpr unsigned char rgba[4 * 4] {};
+  EXPECT_THROW(image.update(1, 0, 2, 1, rgba), reascript_error);
+  EXPECT_THROW(image.update(0, -1, 1, 1, rgba), reascript_error);
+  EXPECT_THROW(image.update(0, 0, 0, 1, rgba), reascript_error);
+  EXPECT_NO_THROW(image.update(0, 0, 2, 2, rgba));
+}
+
+class FailedImage : public Image {
+public:
+  size_t width()  const override { return 0; }
+  size_t height() const override { return 0; }
+  size_t makeTexture(Context *, ImVec2 *, size_t) override { return 0; }
+  ImageState state() const override { return ReaImGuiImageState_Failed; }
+  std::string_view error() const override { return "broken"; }
+};
+
+TEST(ImageSetTest, Error) {
+  PixelImage  ready { 1, 1 };
+  FailedImage failed;
+  ImageSet    set;
+  set.add(1.f, &ready);
+  EXPECT_EQ(set.state(), ReaImGuiImageState_Ready);
+  EXPECT_EQ(set.error(), "");
+
+  set.add(2.f, &failed);
+  EXPECT_EQ(set.state(), ReaImGuiImageState_Failed);
+  EXPECT_EQ(set.error(), "broken");
+}
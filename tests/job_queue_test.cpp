@@ -0,0 +1,65 @@
+#include "../src/job_queue.hpp"
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <future>
+
+TEST(JobQueueTest, WaitOutOfOrder) {
+  std::promise<void> release;
+  std::shared_future<void> released { release.get_future() };
+  std::atomic<bool> firstDone { false };
+  JobQueue queue { 2 };
+
+  queue.push([&] {
+    released.wait();
+    firstDone = true;
+  });
+  const JobQueue::Ticket second { queue.push([] {}) };
+
+  // the second job may complete first, but must not satisfy the wait alone
+  std::thread releaser { [&] {
+    std::this_thread::sleep_for(std::chrono::milliseconds { 10 });
+    release.set_value();
+  }};
+  queue.wait(second);
+  EXPECT_TRUE(firstDone);
+  releaser.join();
+}
+
+TEST(JobQueueTest, RunOne) {
+  JobQueue queue { 0 };
+  EXPECT_FALSE(queue.runOne());
+
+  int count {};
+  const JobQueue::Ticket ticket { queue.push([&count] { ++count; }) };
+  EXPECT_TRUE(queue.runOne());
+  EXPECT_FALSE(queue.runOne());
+  queue.wait(ticket);
+  EXPECT_EQ(count, 1);
+}
+
+TEST(JobQueueTest, WaitAll) {
+  JobQueue queue { 2 };
+  queue.waitAll(); // no job
+
+  std::atomic<int> count {};
+  for(int i {}; i < 10; ++i) {
+    queue.push([&count] {
+      std::this_thread::sleep_for(std::chrono::milliseconds { 1 });
+      ++count;
+    });
+  }
+  queue.waitAll();
+  EXPECT_EQ(count, 10);
+}
+
+TEST(JobQueueTest, RunPendingOnDestruction) {
+  int count {};
+  {
+    JobQueue queue { 1 };
+    for(int i {}; i < 10; ++i)
+      queue.push([&count] { ++count; });
+  }
+  EXPECT_EQ(count, 10);
+}
@@ -0,0 +1,115 @@
+#include "../src/offscreen_viewport.hpp"
+
+#include "../src/image.hpp"
+#include "../src/texture.hpp"
+
+#include <gtest/gtest.h>
+
+#include <cstring>
+#include <imgui/imgui_internal.h>
+#include <memory>
+#include <sstream>
+
+static std::unique_ptr<ImGuiContext, decltype(&ImGui::DestroyContext)> makeContext()
+{
+  return { ImGui::CreateContext(), &ImGui::DestroyContext };
+}
+
+static const unsigned char *getFontPixels(const Texture &texture,
+  int *width, int *height)
+{
+  unsigned char *pixels;
+  auto atlas { static_cast<ImFontAtlas *>(texture.object()) };
+  atlas->GetTexDataAsRGBA32(&pixels, width, height);
+  return pixels;
+}
+
+// renders a 32x24 window at 8,8 containing an 8x8 red color button
+static void renderFrame(OffscreenViewport &viewport, TextureManager &manager)
+{
+  ImGuiIO &io { ImGui::GetIO() };
+  io.IniFilename = nullptr;
+  io.DisplaySize = ImVec2(64, 48);
+  io.Fonts->Build();
+  io.Fonts->SetTexID(manager.touch(io.Fonts, 1.f, &getFontPixels));
+
+  ImGui::NewFrame();
+  ImGui::SetNextWindowPos(ImVec2(8, 8));
+  ImGui::SetNextWindowSize(ImVec2(32, 24));
+  ImGui::Begin("window", nullptr, ImGuiWindowFlags_NoDecoration);
+  ImGui::ColorButton("button", ImVec4(1.f, 0.f, 0.f, 1.f),
+    ImGuiColorEditFlags_NoTooltip, ImVec2(8, 8));
+  ImGui::End();
+  ImGui::Render();
+
+  viewport.render(nullptr);
+}
+
+static ImU32 pixelAt(const std::vector<unsigned char> &rgba,
+  const OffscreenViewport &viewport, const int x, const int y)
+{
+  ImU32 pixel;
+  std::memcpy(&pixel, &rgba[((y * viewport.width()) + x) * 4], sizeof(pixel));
+  return pixel;
+}
+
+TEST(OffscreenViewportTest, Capture) {
+  const auto ctx { makeContext() };
+
+  TextureManager manager;
+  OffscreenViewport viewport { ImGui::GetMainViewport(), &manager };
+  renderFrame(viewport, manager);
+
+  ASSERT_EQ(viewport.width(),  64);
+  ASSERT_EQ(viewport.height(), 48);
+
+  const std::vector<unsigned char> rgba { viewport.capture() };
+  ASSERT_EQ(rgba.size(), 64u * 48u * 4u);
+
+  const ImVec4 &bg { ImGui::GetStyleColorVec4(ImGuiCol_WindowBg) };
+  const ImU32 windowBg { pixelAt(rgba, viewport, 12, 12) };
+  EXPECT_NEAR(windowBg & 0xFF, bg.x * 255, 1);
+  EXPECT_NEAR(windowBg >> 24,  bg.w * 255, 1);
+
+  EXPECT_EQ(pixelAt(rgba, viewport, 2,  2),  0u); // outside of the window
+  EXPECT_EQ(pixelAt(rgba, viewport, 20, 20), IM_COL32(255, 0, 0, 255));
+}
+
+TEST(OffscreenViewportTest, PNG) {
+  const auto ctx { makeContext() };
+
+  TextureManager manager;
+  OffscreenViewport viewport { ImGui::GetMainViewport(), &manager };
+  renderFrame(viewport, manager);
+
+  const std::vector<unsigned char> rgba { viewport.capture() };
+  std::stringstream stream;
+  writePNG(stream, rgba.data(), viewport.width(), viewport.height());
+
+  const std::string png { stream.str() };
+  const std::unique_ptr<Image> image
+    { Image::fromMemory(png.data(), png.size()) };
+  const Bitmap *bitmap { dynamic_cast<const Bitmap *>(image.get()) };
+  ASSERT_TRUE(bitmap);
+  ASSERT_EQ(bitmap->width(),  64u);
+  ASSERT_EQ(bitmap->height(), 48u);
+  EXPECT_EQ(0, std::memcmp(bitmap->pixels(), rgba.data(), rgba.size()));
+}
+
+TEST(OffscreenViewportTest, RenderThread) {
+  const auto ctx { makeContext() };
+
+  TextureManager manager;
+  OffscreenViewport direct   { ImGui::GetMainViewport(), &manager },
+                    threaded { ImGui::GetMainViewport(), &manager, true };
+  renderFrame(threaded, manager);
+  direct.render(nullptr);
+
+  // the next frame may overwrite the draw lists copied by the threaded viewport
+  ImGui::NewFrame();
+  ImGui::Render();
+
+  ASSERT_EQ(threaded.width(),  direct.width());
+  ASSERT_EQ(threaded.height(), direct.height());
+  EXPECT_EQ(threaded.capture(), direct.capture());
+}
@@ -0,0 +1,37 @@
+#include "../src/render_thread.hpp"
+
+#include <gtest/gtest.h>
+
+#include <vector>
+
+TEST(RenderThreadTest, Order) {
+  RenderThread thread;
+  std::vector<int> order;
+
+  RenderThread::Ticket last {};
+  for(int i {}; i < 10; ++i)
+    last = thread.push([&order, i] { order.push_back(i); });
+  thread.wait(last);
+
+  ASSERT_EQ(order.size(), 10u);
+  for(int i {}; i < 10; ++i)
+    EXPECT_EQ(order[i], i);
+}
+
+TEST(RenderThreadTest, Wait) {
+  RenderThread thread;
+  thread.wait(0); // no job
+
+  bool done { false };
+  const RenderThread::Ticket ticket { thread.push([&done] {
+    std::this_thread::sleep_for(std::chrono::milliseconds { 10 });
+    done = true;
+  })};
+  thread.wait(ticket);
+  EXPECT_TRUE(done);
+}
+
+TEST(RenderThreadTest, Shared) {
+  const auto a { RenderThread::get() }, b { RenderThread::get() };
+  EXPECT_EQ(a, b);
+}
@@ -0,0 +1,299 @@
+#include "../src/renderer.hpp"
+
+#include <gtest/gtest.h>
+
+#include <imgui/imgui.h>
+#include <vector>
+
+TEST(StreamBufferTest, Suballocate) {
+  StreamBuffer buffer;
+
+  StreamBuffer::Range range { buffer.allocate(10) };
+  EXPECT_TRUE(range.orphan);
+  EXPECT_EQ(range.offset, 0u);
+  EXPECT_EQ(buffer.capacity(), 40u);
+
+  range = buffer.allocate(20);
+  EXPECT_FALSE(range.orphan);
+  EXPECT_EQ(range.offset, 10u);
+
+  range = buffer.allocate(10);
+  EXPECT_FALSE(range.orphan);
+  EXPECT_EQ(range.offset, 30u);
+
+  range = buffer.allocate(1); // full
+  EXPECT_TRUE(range.orphan);
+  EXPECT_EQ(range.offset, 0u);
+  EXPECT_EQ(buffer.capacity(), 40u);
+
+  range = buffer.allocate(50); // too big
+  EXPECT_TRUE(range.orphan);
+  EXPECT_EQ(range.offset, 0u);
+  EXPECT_EQ(buffer.capacity(), 200u);
+}
+
+TEST(StreamBufferTest, AllocationsPerFrame) {
+  constexpr unsigned int WINDOWS { 100 }, FRAMES { 600 };
+
+  StreamBuffer vertices, indices;
+  unsigned int allocations {};
+
+  for(unsigned int frame {}; frame < FRAMES; ++frame) {
+    size_t vtxCount {}, idxCount {};
+    for(unsigned int window {}; window < WINDOWS; ++window) {
+      const size_t quads { 50 + ((frame + window) % 25) };
+      vtxCount += quads * 4;
+      idxCount += quads * 6;
+    }
+
+    allocations += vertices.allocate(vtxCount).orphan;
+    allocations += indices.allocate(idxCount).orphan;
+  }
+
+  // previously two glBufferData calls per draw list
+  const unsigned int perListAllocations { WINDOWS * 2 * FRAMES };
+  RecordProperty("AllocationsPerDrawList", perListAllocations);
+  RecordProperty("AllocationsStreamed",    allocations);
+  EXPECT_LE(allocations, FRAMES / 2);
+}
+
+static void addCommand(ImDrawList &list, const size_t texture,
+  const ImVec4 &clipRect, const unsigned int quads = 1)
+{
+  ImDrawCmd cmd;
+  cmd.TextureId = texture;
+  cmd.ClipRect  = clipRect;
+  cmd.IdxOffset = list.IdxBuffer.Size;
+  cmd.ElemCount = quads * 6;
+  list.CmdBuffer.push_back(cmd);
+  list.VtxBuffer.resize(list.VtxBuffer.Size + (quads * 4));
+  list.IdxBuffer.resize(list.IdxBuffer.Size + cmd.ElemCount);
+}
+
+TEST(DrawBatchTest, MergeCommands) {
+  constexpr ImVec4 screen { 0, 0, 100, 100 }, button { 10, 10, 20, 20 },
+                   hidden { 10, 10, 10, 10 };
+
+  ImDrawList a { nullptr }, b { nullptr };
+  addCommand(a, 1, screen);
+  addCommand(a, 1, screen); // merged
+  addCommand(a, 1, button);
+  addCommand(a, 2, button);
+  addCommand(a, 2, hidden); // culled
+  addCommand(b, 2, button); // same state in another list
+
+  ImDrawData drawData;
+  drawData.AddDrawList(&a);
+  drawData.AddDrawList(&b);
+
+  DrawBatch batch;
+  batch.build(&drawData, ImVec2(2.f, 2.f));
+  const std::vector<DrawBatch::Call> calls(batch.begin(), batch.end());
+  ASSERT_EQ(calls.size(), 4u);
+
+  EXPECT_EQ(calls[0].clipRect, ClipRect(screen, ImVec2(), ImVec2(2.f, 2.f)));
+  EXPECT_EQ(calls[0].elemCount, 12u);
+  EXPECT_TRUE(calls[0].setClipRect);
+  EXPECT_TRUE(calls[0].setTexture);
+
+  EXPECT_EQ(calls[1].idxOffset, 12u);
+  EXPECT_TRUE(calls[1].setClipRect);
+  EXPECT_FALSE(calls[1].setTexture);
+
+  EXPECT_FALSE(calls[2].setClipRect);
+  EXPECT_TRUE(calls[2].setTexture);
+
+  EXPECT_EQ(calls[3].vtxOffset, static_cast<unsigned int>(a.VtxBuffer.Size));
+  EXPECT_EQ(calls[3].idxOffset, static_cast<unsigned int>(a.IdxBuffer.Size));
+  EXPECT_FALSE(calls[3].setClipRect);
+  EXPECT_FALSE(calls[3].setTexture);
+
+  const DrawBatch::Stats &stats { batch.stats() };
+  EXPECT_EQ(stats.commands,  6u);
+  EXPECT_EQ(stats.drawCalls, 4u);
+  EXPECT_EQ(stats.clipRects, 2u);
+  EXPECT_EQ(stats.textures,  2u);
+}
+
+TEST(DrawBatchTest, StateChangesPerFrame) {
+  constexpr unsigned int WINDOWS { 100 };
+  constexpr ImVec4 screen { 0, 0, 1920, 1080 };
+
+  // windows made of text and frames sharing the font atlas
+  std::vector<ImDrawList> lists(WINDOWS, ImDrawList { nullptr });
+  ImDrawData drawData;
+  for(ImDrawList &list : lists) {
+    addCommand(list, 1, screen, 50);
+    addCommand(list, 1, screen, 20);
+    drawData.AddDrawList(&list);
+  }
+
+  DrawBatch batch;
+  batch.build(&drawData, ImVec2(1.f, 1.f));
+
+  const DrawBatch::Stats &stats { batch.stats() };
+  RecordProperty("Commands",  stats.commands);
+  RecordProperty("DrawCalls", stats.drawCalls);
+  RecordProperty("StateChanges", stats.clipRects + stats.textures);
+  EXPECT_EQ(stats.drawCalls, WINDOWS);
+  EXPECT_EQ(stats.clipRects, 1u);
+  EXPECT_EQ(stats.textures,  1u);
+}
+
+TEST(FrameHashTest, DrawData) {
+  constexpr ImVec4 screen { 0, 0, 100, 100 };
+
+  ImDrawList list { nullptr };
+  addCommand(list, 1, screen, 2);
+  ImDrawData drawData;
+  drawData.AddDrawList(&list);
+
+  const auto hash { [&drawData] {
+    FrameHash hash;
+    hash.addDrawData(&drawData);
+    return hash.value();
+  }};
+
+  const uint64_t unchanged { hash() };
+  EXPECT_EQ(hash(), unchanged);
+
+  list.VtxBuffer[3].col = 0xFFFFFFFF;
+  const uint64_t vertexChanged { hash() };
+  EXPECT_NE(vertexChanged, unchanged);
+
+  list.CmdBuffer[0].TextureId = 2;
+  const uint64_t textureChanged { hash() };
+  EXPECT_NE(textureChanged, vertexChanged);
+
+  list.CmdBuffer[0].ClipRect.z = 50;
+  EXPECT_NE(hash(), textureChanged);
+}
+
+TEST(DrawDataSnapshotTest, DeepCopy) {
+  constexpr ImVec4 screen { 0, 0, 100, 100 };
+
+  ImDrawList list { nullptr };
+  addCommand(list, 1, screen, 2);
+  list.VtxBuffer[0].col = 0xFF0000FF;
+  ImDrawData drawData;
+  drawData.AddDrawList(&list);
+  drawData.DisplaySize = ImVec2(100, 100);
+
+  DrawDataSnapshot snapshot;
+  snapshot.copy(&drawData);
+  const ImDrawData *copy { snapshot.get() };
+  ASSERT_EQ(copy->CmdListsCount, 1);
+  EXPECT_EQ(copy->DisplaySize.x, 100);
+  const ImDrawList *copiedList { copy->CmdLists[0] };
+  EXPECT_NE(copiedList, &list);
+
+  // the next frame is built into the same draw list
+  list.VtxBuffer[0].col = 0xFFFFFFFF;
+  list.CmdBuffer[0].TextureId = 2;
+  EXPECT_EQ(copiedList->VtxBuffer.Size, 8);
+  EXPECT_EQ(copiedList->IdxBuffer.Size, 12);
+  EXPECT_EQ(copiedList->VtxBuffer[0].col, 0xFF0000FFu);
+  EXPECT_EQ(copiedList->CmdBuffer[0].GetTexID(), 1u);
+
+  FrameHash original, copied;
+  snapshot.copy(&drawData);
+  original.addDrawData(&drawData);
+  copied.addDrawData(snapshot.get());
+  EXPECT_EQ(snapshot.get()->CmdLists[0], copiedList); // storage is reused
+  EXPECT_EQ(copied.value(), original.value());
+}
+
+static void addQuad(ImDrawList &list, const ImVec4 &rect, const ImU32 col)
+{
+  const auto base { static_cast<ImDrawIdx>(list.VtxBuffer.Size) };
+  const ImVec2 uv { 0, 0 };
+  list.VtxBuffer.push_back({ ImVec2(rect.x, rect.y), uv, col });
+  list.VtxBuffer.push_back({ ImVec2(rect.z, rect.y), uv, col });
+  list.VtxBuffer.push_back({ ImVec2(rect.z, rect.w), uv, col });
+  list.VtxBuffer.push_back({ ImVec2(rect.x, rect.w), uv, col });
+  for(const ImDrawIdx i : { 0, 1, 2, 0, 2, 3 })
+    list.IdxBuffer.push_back(base + i);
+  list.CmdBuffer.back().ElemCount += 6;
+}
+
+TEST(DamageTrackerTest, Regions) {
+  constexpr ImVec4 screen { 0, 0, 100, 100 }, a { 10, 10, 20, 20 },
+                   b { 40, 40, 50, 50 }, c { 70, 70, 80, 80 },
+                   cursor { 45.5f, 60, 46.5f, 64 };
+  constexpr ImU32 white { 0xFFFFFFFF }, red { 0xFF0000FF };
+
+  const auto makeFrame { [&](ImDrawList &list, const bool showCursor, const ImU32 colB) {
+    list.CmdBuffer.clear();
+    list.VtxBuffer.clear();
+    list.IdxBuffer.clear();
+    addCommand(list, 1, screen, 0);
+    addQuad(list, a, white);
+    addQuad(list, b, colB);
+    if(showCursor)
+      addQuad(list, cursor, white);
+    addQuad(list, c, white);
+  }};
+
+  ImDrawList list { nullptr };
+  ImDrawData drawData;
+  drawData.AddDrawList(&list);
+  drawData.DisplaySize = ImVec2(100, 100);
+
+  DamageTracker tracker;
+  makeFrame(list, false, white);
+  tracker.update(&drawData, ImVec2(1.f, 1.f));
+  ASSERT_EQ(tracker.regions().size(), 1u); // first frame
+  EXPECT_EQ(tracker.regions()[0], ClipRect(0, 0, 100, 100));
+
+  tracker.update(&drawData, ImVec2(1.f, 1.f));
+  EXPECT_TRUE(tracker.regions().empty());
+
+  makeFrame(list, true, white); // inserted
+  tracker.update(&drawData, ImVec2(1.f, 1.f));
+  ASSERT_EQ(tracker.regions().size(), 1u);
+  EXPECT_EQ(tracker.regions()[0], ClipRect(45, 60, 47, 64));
+
+  makeFrame(list, true, red); // changed in place
+  tracker.update(&drawData, ImVec2(1.f, 1.f));
+  ASSERT_EQ(tracker.regions().size(), 1u);
+  EXPECT_EQ(tracker.regions()[0], ClipRect(40, 40, 50, 50));
+
+  drawData.DisplaySize = ImVec2(50, 100); // resized
+  tracker.update(&drawData, ImVec2(1.f, 1.f));
+  ASSERT_EQ(tracker.regions().size(), 1u);
+  EXPECT_EQ(tracker.regions()[0], ClipRect(0, 0, 50, 100));
+
+  tracker.invalidate();
+  tracker.update(&drawData, ImVec2(1.f, 1.f));
+  ASSERT_EQ(tracker.regions().size(), 1u);
+  EXPECT_EQ(tracker.regions()[0], ClipRect(0, 0, 50, 100));
+}
+
+TEST(DamageTrackerTest, MaxRegions) {
+  constexpr ImVec4 screen { 0, 0, 1000, 1000 };
+
+  ImDrawList list { nullptr };
+  addCommand(list, 1, screen, 0);
+  for(int i {}; i < 10; ++i) {
+    const float pos ( i * 100 );
+    addQuad(list, ImVec4(pos, pos, pos + 10, pos + 10), 0xFFFFFFFF);
+  }
+  ImDrawData drawData;
+  drawData.AddDrawList(&list);
+  drawData.DisplaySize = ImVec2(1000, 1000);
+
+  DamageTracker tracker;
+  tracker.update(&drawData, ImVec2(1.f, 1.f));
+
+  // animate every other quad
+  for(size_t i {}; i < static_cast<size_t>(list.VtxBuffer.Size); i += 8)
+    list.VtxBuffer[i].col = 0xFF00FF00;
+  tracker.update(&drawData, ImVec2(1.f, 1.f));
+
+  const std::vector<ClipRect> &regions { tracker.regions() };
+  EXPECT_EQ(regions.size(), DamageTracker::MAX_REGIONS);
+  long long damaged {};
+  for(const ClipRect &region : regions)
+    damaged += (region.right - region.left) * (region.bottom - region.top);
+  EXPECT_LT(damaged, 1000 * 1000 / 2);
+}
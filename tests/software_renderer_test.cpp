@@ -0,0 +1,86 @@
+#include "../src/software_renderer.hpp"
+
+#include <gtest/gtest.h>
+
+static const Rasterizer::Image WHITE { 1, 1, { 0xFF, 0xFF, 0xFF, 0xFF } };
+
+static void drawQuad(Rasterizer &rasterizer, const ImVec2 &min, const ImVec2 &max,
+  const ImU32 col, const Rasterizer::Image &image = WHITE,
+  const ImVec4 &clipRect = ImVec4(0, 0, 1000, 1000))
+{
+  const ImDrawVert vertices[] {
+    { min,                ImVec2(0, 0), col },
+    { ImVec2(max.x, min.y), ImVec2(1, 0), col },
+    { max,                ImVec2(1, 1), col },
+    { ImVec2(min.x, max.y), ImVec2(0, 1), col },
+  };
+  constexpr ImDrawIdx indices[] { 0, 1, 2, 0, 2, 3 };
+  rasterizer.drawTriangles(vertices, indices, std::size(indices), image,
+    ClipRect(clipRect, ImVec2(), ImVec2(1, 1)));
+}
+
+TEST(RasterizerTest, SolidQuad) {
+  Rasterizer rasterizer;
+  rasterizer.resize(10, 10);
+  drawQuad(rasterizer, ImVec2(2, 2), ImVec2(6, 6), IM_COL32(255, 0, 0, 255));
+
+  EXPECT_EQ(rasterizer.pixel(2, 2), 0xFFFF0000u);
+  EXPECT_EQ(rasterizer.pixel(5, 5), 0xFFFF0000u);
+  EXPECT_EQ(rasterizer.pixel(1, 1), 0u);
+  EXPECT_EQ(rasterizer.pixel(6, 6), 0u);
+  EXPECT_EQ(rasterizer.pixel(6, 2), 0u);
+}
+
+TEST(RasterizerTest, BlendOnce) {
+  Rasterizer rasterizer;
+  rasterizer.resize(33, 17);
+  // the diagonal shared by both triangles must not be blended twice
+  drawQuad(rasterizer, ImVec2(0, 0), ImVec2(33, 17), IM_COL32(255, 255, 255, 128));
+
+  for(int y {}; y < rasterizer.height(); ++y) {
+    for(int x {}; x < rasterizer.width(); ++x)
+      ASSERT_EQ(rasterizer.pixel(x, y), 0x80808080u) << x << ',' << y;
+  }
+}
+
+TEST(RasterizerTest, Scissor) {
+  Rasterizer rasterizer;
+  rasterizer.resize(10, 10);
+  drawQuad(rasterizer, ImVec2(0, 0), ImVec2(10, 10), IM_COL32(0, 0, 255, 255),
+    WHITE, ImVec4(3, 4, 5, 6));
+
+  for(int y {}; y < rasterizer.height(); ++y) {
+    for(int x {}; x < rasterizer.width(); ++x) {
+      const bool inside { x >= 3 && x < 5 && y >= 4 && y < 6 };
+      EXPECT_EQ(rasterizer.pixel(x, y), inside ? 0xFF0000FFu : 0u) << x << ',' << y;
+    }
+  }
+}
+
+TEST(RasterizerTest, Texture) {
+  const Rasterizer::Image checker { 2, 2, {
+    0xFF, 0x00, 0x00, 0xFF,   0x00, 0xFF, 0x00, 0xFF,
+    0x00, 0x00, 0xFF, 0xFF,   0xFF, 0xFF, 0xFF, 0x00,
+  }};
+
+  Rasterizer rasterizer;
+  rasterizer.resize(4, 4);
+  drawQuad(rasterizer, ImVec2(0, 0), ImVec2(4, 4), IM_COL32_WHITE, checker);
+
+  EXPECT_EQ(rasterizer.pixel(0, 0), 0xFFFF0000u);
+  EXPECT_EQ(rasterizer.pixel(3, 0), 0xFF00FF00u);
+  EXPECT_EQ(rasterizer.pixel(0, 3), 0xFF0000FFu);
+  EXPECT_EQ(rasterizer.pixel(3, 3), 0u); // transparent texel
+}
+
+TEST(RasterizerTest, Transform) {
+  Rasterizer rasterizer;
+  rasterizer.resize(8, 8);
+  rasterizer.setTransform(ImVec2(100, 100), 2.f);
+  drawQuad(rasterizer, ImVec2(101, 101), ImVec2(102, 102), IM_COL32_WHITE);
+
+  EXPECT_EQ(rasterizer.pixel(1, 1), 0u);
+  EXPECT_EQ(rasterizer.pixel(2, 2), 0xFFFFFFFFu);
+  EXPECT_EQ(rasterizer.pixel(3, 3), 0xFFFFFFFFu);
+  EXPECT_EQ(rasterizer.pixel(4, 4), 0u);
+}
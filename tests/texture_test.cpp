@@ -19,10 +19,15 @@ private:
 
 static bool operator==(const TextureCmd &a, const TextureCmd &b)
 {
+  const bool sameRegion { a.type != TextureCmd::UpdateRegion ||
+    (a.region.left  == b.region.left  && a.region.top    == b.region.top &&
+     a.region.right == b.region.right && a.region.bottom == b.region.bottom) };
+
   return a.manager == b.manager &&
          a.type    == b.type    &&
          a.offset  == b.offset  &&
-         a.size    == b.size;
+         a.size    == b.size    &&
+         sameRegion;
 }
 
 static std::ostream &operator<<(std::ostream &os, const TextureCmd &cmd)
@@ -30,9 +35,15 @@ static std::ostream &operator<<(std::ostream &os, const TextureCmd &cmd)
   switch(cmd.type) {
   case TextureCmd::Insert: os << "Insert"; break;
   case TextureCmd::Update: os << "Update"; break;
+  case TextureCmd::UpdateRegion: os << "UpdateRegion"; break;
   case TextureCmd::Remove: os << "Remove"; break;
   }
-  os << '(' << cmd.offset << ", " << cmd.size << ')';
+  os << '(' << cmd.offset << ", " << cmd.size;
+  if(cmd.type == TextureCmd::UpdateRegion) {
+    os << ", {" << cmd.region.left  << ", " << cmd.region.top    << ", "
+                << cmd.region.right << ", " << cmd.region.bottom << '}';
+  }
+  os << ')';
   return os;
 }
 
@@ -66,6 +77,24 @@ TEST(TextureTest, InsertTail) {
   }));
 }
 
+TEST(TextureTest, Synced) {
+  std::unique_ptr<ImGuiContext, decltype(&ImGui::DestroyContext)> ctx
+    { ImGui::CreateContext(), &ImGui::DestroyContext };
+
+  CmdVector      cmds;
+  TextureManager manager;
+  TextureCookie  cookie;
+  EXPECT_TRUE(manager.isSynced(cookie));
+
+  manager.touch((void *)0x10, 1.f, nullptr);
+  EXPECT_FALSE(manager.isSynced(cookie));
+  manager.update(&cookie, LogCmds { cmds });
+  EXPECT_TRUE(manager.isSynced(cookie));
+
+  manager.invalidate((void *)0x10);
+  EXPECT_FALSE(manager.isSynced(cookie));
+}
+
 TEST(TextureTest, InsertMiddle) {
   std::unique_ptr<ImGuiContext, decltype(&ImGui::DestroyContext)> ctx
     { ImGui::CreateContext(), &ImGui::DestroyContext };
@@ -137,6 +166,32 @@ TEST(TextureTest, RemoveMiddle) {
   }));
 }
 
+TEST(TextureTest, UpdateAndRemove) {
+  std::unique_ptr<ImGuiContext, decltype(&ImGui::DestroyContext)> ctx
+    { ImGui::CreateContext(), &ImGui::DestroyContext };
+
+  CmdVector      cmds;
+  TextureManager manager;
+  TextureCookie  cookie;
+
+  manager.touch((void *)0x10, 1.f, nullptr);
+  manager.touch((void *)0x20, 1.f, nullptr);
+  manager.touch((void *)0x30, 1.f, nullptr);
+  manager.touch((void *)0x40, 1.f, nullptr);
+  manager.update(&cookie, LogCmds { cmds });
+  cmds.clear();
+
+  manager.invalidate((void *)0x10);
+  manager.remove((void *)0x20);
+  manager.remove((void *)0x40);
+  manager.update(&cookie, LogCmds { cmds });
+  EXPECT_THAT(cmds, testing::ElementsAreArray(CmdVector {
+    { &manager, TextureCmd::Update, 0, 1 },
+    { &manager, TextureCmd::Remove, 1, 1 },
+    { &manager, TextureCmd::Remove, 2, 1 },
+  }));
+}
+
 TEST(TextureTest, CleanupInactive) {
   std::unique_ptr<ImGuiContext, decltype(&ImGui::DestroyContext)> ctx
     { ImGui::CreateContext(), &ImGui::DestroyContext };
@@ -274,6 +329,55 @@ TEST(TextureTest, Update) {
   }));
 }
 
+TEST(TextureTest, UpdateRegion) {
+  std::unique_ptr<ImGuiContext, decltype(&ImGui::DestroyContext)> ctx
+    { ImGui::CreateContext(), &ImGui::DestroyContext };
+
+  CmdVector      cmds;
+  TextureManager manager;
+  TextureCookie  cookie;
+
+  manager.touch((void *)0x10, 1.f, nullptr);
+  manager.touch((void *)0x20, 1.f, nullptr);
+  manager.touch((void *)0x30, 1.f, nullptr);
+  manager.update(&cookie, LogCmds { cmds });
+  cmds.clear();
+
+  manager.invalidate((void *)0x10, { 0, 0, 4, 512 });
+  manager.invalidate((void *)0x10, { 8, 16, 12, 32 });
+  manager.invalidate((void *)0x20, { 0, 0, 4, 4 });
+  manager.invalidate((void *)0x20);
+  manager.invalidate((void *)0x30);
+  manager.update(&cookie, LogCmds { cmds });
+  EXPECT_THAT(cmds, testing::ElementsAreArray(CmdVector {
+    { &manager, TextureCmd::UpdateRegion, 0, 1, { 0, 0, 12, 512 } },
+    { &manager, TextureCmd::Update, 1, 2 }, // full update wins over regions
+  }));
+}
+
+TEST(TextureTest, UpdateRegionFallback) {
+  std::unique_ptr<ImGuiContext, decltype(&ImGui::DestroyContext)> ctx
+    { ImGui::CreateContext(), &ImGui::DestroyContext };
+
+  CmdVector      cmds;
+  TextureManager manager;
+  TextureCookie  cookie;
+
+  manager.touch((void *)0x10, 1.f, nullptr);
+  manager.touch((void *)0x20, 1.f, nullptr);
+  manager.update(&cookie, LogCmds { cmds });
+  cmds.clear();
+
+  // the full diff has no knowledge of the changed regions
+  manager.invalidate((void *)0x20, { 0, 0, 4, 4 });
+  manager.remove((void *)0x10);
+  manager.update(&cookie, LogCmds { cmds });
+  EXPECT_THAT(cmds, testing::ElementsAreArray(CmdVector {
+    { &manager, TextureCmd::Remove, 0, 1 },
+    { &manager, TextureCmd::Update, 0, 1 },
+  }));
+}
+
 TEST(TextureTest, InsertAfterRemove) {
   std::unique_ptr<ImGuiContext, decltype(&ImGui::DestroyContext)> ctx
     { ImGui::CreateContext(), &ImGui::DestroyContext };
@@ -336,3 +440,148 @@ TEST(TextureTest, UpdateOnReinsertion) {
     { &manager, TextureCmd::Update, 0, 1 },
   }));
 }
+
+TEST(TextureTest, ManyTextures) {
+  std::unique_ptr<ImGuiContext, decltype(&ImGui::DestroyContext)> ctx
+    { ImGui::CreateContext(), &ImGui::DestroyContext };
+
+  constexpr size_t COUNT { 10'000 };
+
+  CmdVector      cmds;
+  TextureManager manager;
+  TextureCookie  cookie;
+
+  // descending object addresses: worst case for a sorted index
+  for(size_t i {}; i < COUNT; ++i)
+    ASSERT_EQ(manager.touch(reinterpret_cast<void *>(COUNT - i), 1.f, nullptr), i);
+  for(size_t i {}; i < COUNT; ++i) {
+    void *object { reinterpret_cast<void *>(COUNT - i) };
+    ASSERT_EQ(manager.touch(object, 2.f, nullptr), COUNT + i);
+    ASSERT_EQ(manager.touch(object, 1.f, nullptr), i);
+  }
+  manager.update(&cookie, LogCmds { cmds });
+  EXPECT_THAT(cmds, testing::ElementsAreArray(CmdVector {
+    { &manager, TextureCmd::Insert, 0, COUNT * 2 },
+  }));
+  cmds.clear();
+
+  manager.invalidate(reinterpret_cast<void *>(COUNT / 2));
+  manager.update(&cookie, LogCmds { cmds });
+  EXPECT_THAT(cmds, testing::ElementsAreArray(CmdVector {
+    { &manager, TextureCmd::Update, COUNT / 2, 1 },
+    { &manager, TextureCmd::Update, COUNT + (COUNT / 2), 1 },
+  }));
+  cmds.clear();
+
+  manager.remove(reinterpret_cast<void *>(COUNT));
+  manager.update(&cookie, LogCmds { cmds });
+  EXPECT_THAT(cmds, testing::ElementsAreArray(CmdVector {
+    { &manager, TextureCmd::Remove, 0, 1 },
+    { &manager, TextureCmd::Remove, COUNT - 1, 1 },
+  }));
+
+  for(size_t i { 1 }; i < COUNT; ++i) {
+    void *object { reinterpret_cast<void *>(COUNT - i) };
+    ASSERT_EQ(manager.touch(object, 1.f, nullptr), i - 1);
+    ASSERT_EQ(manager.touch(object, 2.f, nullptr), COUNT + i - 2);
+  }
+}
+
+TEST(TextureTest, BudgetEviction) {
+  std::unique_ptr<ImGuiContext, decltype(&ImGui::DestroyContext)> ctx
+    { ImGui::CreateContext(), &ImGui::DestroyContext };
+
+  CmdVector      cmds;
+  TextureManager manager;
+  TextureCookie  cookie;
+
+  const auto upload { [&cmds](const TextureCmd &cmd) {
+    cmds.push_back(cmd);
+    if(cmd.type != TextureCmd::Remove)
+      cmd.manager->addUploads(cmd.size);
+  }};
+  const auto getPixels { [](const Texture &, int *width, int *height) {
+    *width = *height = 16; // 1 KiB
+    return static_cast<const unsigned char *>(nullptr);
+  }};
+
+  for(size_t i { 1 }; i <= 4; ++i) {
+    ctx->Time = i;
+    manager.touch(reinterpret_cast<void *>(i * 0x10), 1.f, +getPixels);
+  }
+  manager.update(&cookie, upload);
+  cmds.clear();
+
+  manager.setBudget(2048);
+  manager.cleanup();
+  manager.update(&cookie, upload);
+  EXPECT_THAT(cmds, testing::ElementsAreArray(CmdVector {
+    { &manager, TextureCmd::Remove, 0, 2 }, // 0x10, 0x20
+  }));
+  cmds.clear();
+
+  TextureManager::Stats stats { manager.stats() };
+  EXPECT_EQ(stats.textures,  2u);
+  EXPECT_EQ(stats.bytes,     2048u);
+  EXPECT_EQ(stats.uploads,   4u);
+  EXPECT_EQ(stats.evictions, 2u);
+
+  // textures active during the previous frame are never evicted
+  ctx->Time = 5;
+  manager.touch((void *)0x30, 1.f, +getPixels);
+  manager.touch((void *)0x40, 1.f, +getPixels);
+  manager.setBudget(1);
+  manager.cleanup();
+  manager.update(&cookie, upload);
+  EXPECT_THAT(cmds, testing::IsEmpty());
+
+  stats = manager.stats();
+  EXPECT_EQ(stats.textures, 2u);
+  EXPECT_EQ(stats.uploads,  0u);
+}
+
+TEST(TextureTest, BytesOfSharedTextures) {
+  std::unique_ptr<ImGuiContext, decltype(&ImGui::DestroyContext)> ctx
+    { ImGui::CreateContext(), &ImGui::DestroyContext };
+
+  TextureManager manager;
+  TextureCookie  cookie;
+
+  const auto getPixels { [](const Texture &, int *width, int *height) {
+    *width = *height = 16; // 1 KiB
+    return static_cast<const unsigned char *>(nullptr);
+  }};
+
+  // as if already uploaded by another context sharing the texture
+  manager.touch((void *)0x10, 1.f, +getPixels, nullptr, nullptr,
+    TextureShareId { 1 });
+  manager.update(&cookie, [](const TextureCmd &) {});
+  EXPECT_EQ(manager.stats().bytes, 1024u);
+
+  ctx->Time = 1;
+  manager.setBudget(1);
+  manager.cleanup();
+  EXPECT_EQ(manager.stats().textures, 0u);
+  EXPECT_EQ(manager.stats().uploads,  0u);
+}
+
+TEST(TextureTest, BytesAfterInvalidate) {
+  std::unique_ptr<ImGuiContext, decltype(&ImGui::DestroyContext)> ctx
+    { ImGui::CreateContext(), &ImGui::DestroyContext };
+
+  static int size { 16 };
+  const auto getPixels { [](const Texture &, int *width, int *height) {
+    *width = *height = size;
+    return static_cast<const unsigned char *>(nullptr);
+  }};
+
+  TextureManager manager;
+  manager.touch((void *)0x10, 1.f, +getPixels);
+  EXPECT_EQ(manager.stats().bytes, 1024u);
+
+  size = 32;
+  manager.invalidate((void *)0x10, { 0, 0, 1, 1 });
+  EXPECT_EQ(manager.stats().bytes, 1024u);
+  manager.invalidate((void *)0x10);
+  EXPECT_EQ(manager.stats().bytes, 4096u);
+}
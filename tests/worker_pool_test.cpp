@@ -0,0 +1,44 @@
+#include "../src/worker_pool.hpp"
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+
+TEST(WorkerPoolTest, RunAll) {
+  WorkerPool pool { 3 };
+  EXPECT_EQ(pool.size(), 3u);
+
+  std::vector<int> results(100);
+  std::vector<WorkerPool::Job> jobs;
+  for(size_t i {}; i < results.size(); ++i)
+    jobs.push_back([&results, i] { results[i] = i * 2; });
+
+  for(int batch {}; batch < 3; ++batch) {
+    std::fill(results.begin(), results.end(), -1);
+    pool.run(jobs);
+    for(size_t i {}; i < results.size(); ++i)
+      ASSERT_EQ(results[i], static_cast<int>(i * 2)) << i;
+  }
+}
+
+TEST(WorkerPoolTest, Concurrent) {
+  WorkerPool pool { 1 };
+
+  // both jobs can only return if they run at the same time
+  std::atomic<int> arrived { 0 };
+  const WorkerPool::Job job { [&arrived] {
+    ++arrived;
+    while(arrived < 2)
+      std::this_thread::yield();
+  }};
+  pool.run({ job, job });
+  EXPECT_EQ(arrived, 2);
+}
+
+TEST(WorkerPoolTest, NoThreads) {
+  WorkerPool pool { 0 };
+
+  int count {};
+  pool.run({ [&count] { ++count; }, [&count] { ++count; } });
+  EXPECT_EQ(count, 2);
+}